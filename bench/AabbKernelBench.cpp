@@ -0,0 +1,76 @@
+#include "../source/kantan/AabbKernel/AabbKernel.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+    AABB kernel micro-benchmark.
+    Tests random movers against a batch of boxes with every instruction set available on this machine
+    and reports the number of pair tests per second. Build it in Release to get meaningful numbers.
+**/
+int main()
+{
+    const std::size_t boxCount = 4096;
+    const std::size_t queryCount = 1024;
+
+    // Same scene for every level.
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(0.f, 4096.f);
+    std::uniform_real_distribution<float> size(8.f, 64.f);
+
+    kantan::AabbArrays boxes;
+    boxes.reserve(boxCount);
+    for(std::size_t i(0) ; i < boxCount ; ++i)
+        boxes.push(sf::FloatRect(position(rng), position(rng), size(rng), size(rng)));
+
+    std::vector<sf::FloatRect> queries;
+    for(std::size_t i(0) ; i < queryCount ; ++i)
+        queries.push_back(sf::FloatRect(position(rng), position(rng), size(rng) * 4.f, size(rng) * 4.f));
+
+    std::vector<unsigned int> hits;
+    hits.reserve(boxCount);
+
+    std::size_t referenceHits = 0;
+    const kantan::SimdLevel levels[] = {kantan::SimdLevel::Scalar, kantan::SimdLevel::SSE, kantan::SimdLevel::AVX2, kantan::SimdLevel::AVX512};
+
+    for(kantan::SimdLevel level : levels)
+    {
+        if(!kantan::isSimdLevelSupported(level))
+        {
+            std::cout << kantan::getSimdLevelName(level) << ": not supported" << std::endl;
+            continue;
+        }
+
+        kantan::AabbKernel kernel(level);
+
+        // Run whole passes over the queries for at least half a second.
+        std::size_t passes = 0, found = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed(0.0);
+
+        while(elapsed.count() < 0.5)
+        {
+            found = 0;
+            for(const sf::FloatRect& query : queries)
+            {
+                hits.clear();
+                found += kernel.findIntersections(query, boxes, hits);
+            }
+
+            ++passes;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        // Every level must agree with the scalar one.
+        if(level == kantan::SimdLevel::Scalar)
+            referenceHits = found;
+
+        double tests = static_cast<double>(passes) * queryCount * boxCount;
+        std::cout << kantan::getSimdLevelName(level) << ": " << tests / elapsed.count() / 1e6 << " M pair tests/s"
+                  << (found == referenceHits ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "../source/kantan/CommandBuffer/CommandBuffer.hpp"
+#include "../source/kantan/RenderBackend/RenderBackend.hpp"
+
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+
+/**
+    Command replay benchmark.
+    Replays a frame captured in game ([F12], saved to frame.kcb) on an off-screen target, without any game logic,
+    and reports the time of one replay (sort and draw calls). The textures are replaced by blank ones of the same ids
+    and the texts use the game font, so run it from the game folder. The static geometry (walls) is not in the file
+    and is skipped. Build it in Release to get meaningful numbers.
+**/
+int main(int argc, char** argv)
+{
+    const std::string filename = argc > 1 ? argv[1] : "frame.kcb";
+
+    kantan::CommandBuffer frame;
+    try
+    {
+        frame.loadFromFile(filename);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    // Target of the game window size, which also gives the OpenGL context of the textures.
+    sf::RenderTexture target;
+    if(!target.create(768, 768))
+    {
+        std::cerr << "Failed to create the render texture" << std::endl;
+        return 1;
+    }
+
+    sf::Image blank;
+    blank.create(2048, 2048, sf::Color::White);
+
+    sf::Font font;
+    bool hasFont = font.loadFromFile("media/fonts/OpenSans-Regular.ttf");
+
+    // Every resource used by the frame.
+    kantan::RenderResources resources;
+    std::map<std::uint32_t, sf::Texture> textures;
+    std::size_t textCount = 0;
+
+    for(const kantan::RenderCommand& command : frame.getCommands())
+    {
+        if(command.type == kantan::RenderCommand::Text)
+        {
+            ++textCount;
+            if(hasFont)
+                resources.addFont(command.resource, font);
+        }
+        else if(command.type == kantan::RenderCommand::Vertices && command.resource != kantan::RenderResources::NoResource && textures.count(command.resource) == 0)
+        {
+            textures[command.resource].loadFromImage(blank);
+            resources.addTexture(command.resource, textures[command.resource]);
+        }
+    }
+
+    std::cout << filename << ": " << frame.getCommands().size() << " commands, " << frame.getVertices().size() << " vertices, "
+              << textCount << " texts" << (hasFont ? "" : " (no font, not drawn)") << std::endl;
+
+    kantan::RenderBackend backend(&resources);
+
+    // Replay the frame for at least half a second.
+    std::size_t replays = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed(0.0);
+
+    while(elapsed.count() < 0.5)
+    {
+        target.clear(sf::Color::White);
+        backend.execute(frame, target);
+        target.display();
+
+        ++replays;
+        elapsed = std::chrono::steady_clock::now() - start;
+    }
+
+    std::cout << backend.getDrawCount() << " draw calls, " << elapsed.count() * 1e6 / replays << " us per replay" << std::endl;
+
+    return 0;
+}
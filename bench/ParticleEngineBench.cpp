@@ -0,0 +1,79 @@
+#include "../source/kantan/ParticleEngine/ParticleEngine.hpp"
+#include "../source/kantan/ThreadPool/ThreadPool.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+/**
+    Particle engine micro-benchmark.
+    Updates the same pool of particles with 1 to 16 threads and reports the number of particles updated per millisecond.
+    Build it in Release to get meaningful numbers.
+**/
+int main()
+{
+    const std::size_t particleCount = 1 << 20;
+    const unsigned int threadCounts[] = {1, 2, 4, 8, 12, 16};
+
+    // Same bursts for every thread count, lasting longer than the benchmark.
+    kantan::ParticleBurst burst;
+    burst.color = sf::Color::Red;
+    burst.count = 1000;
+    burst.duration = sf::seconds(3600.f);
+    burst.minSpeed = 20.f;
+    burst.maxSpeed = 70.f;
+    burst.minLifetime = sf::seconds(1.f);
+    burst.maxLifetime = sf::seconds(3.f);
+    burst.priority = 0;
+
+    // Fills an engine with the bursts, from the same seed.
+    auto fill = [&burst](kantan::ParticleEngine& particles)
+    {
+        particles.setSeed(42);
+
+        for(std::size_t i(0) ; i + burst.count <= particleCount ; i += burst.count)
+        {
+            burst.center = sf::Vector2f(static_cast<float>(i % 768), static_cast<float>(i / 768 % 768));
+            particles.addBurst(burst);
+        }
+    };
+
+    // One single thread update, to check the others against.
+    const sf::Time step = sf::seconds(1.f / 120.f);
+
+    kantan::ParticleEngine reference(particleCount);
+    fill(reference);
+    reference.update(step);
+
+    for(unsigned int threadCount : threadCounts)
+    {
+        kantan::ThreadPool threads(threadCount);
+        kantan::ParticleEngine particles(particleCount);
+        particles.setThreadPool(&threads);
+        fill(particles);
+
+        // The first update must give the same vertices as the single thread one.
+        particles.update(step);
+        bool same = particles.size() == reference.size()
+            && std::memcmp(particles.getVertices(), reference.getVertices(), particles.size() * sizeof(sf::Vertex)) == 0;
+
+        // Run whole updates for at least half a second.
+        std::size_t updates = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> elapsed(0.0);
+
+        while(elapsed.count() < 500.0)
+        {
+            particles.update(step);
+
+            ++updates;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+
+        double rate = static_cast<double>(updates) * particles.size() / elapsed.count();
+        std::cout << threadCount << " thread(s): " << rate << " particles/ms"
+                  << (same ? "" : " (MISMATCH)") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "../source/kantan/AabbKernel/AabbKernel.hpp"
+#include "../source/kantan/Entity/Entity.hpp"
+#include "../source/kantan/ProjectileBatch/ProjectileBatch.hpp"
+#include "../source/kantan/SweptAabb/SweptAabb.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+/**
+    Projectile batch micro-benchmark.
+    10k balls and sakuras (half falling, half rising) in the play area, with a player and the bottom wall,
+    stepped by the packed projectile batch and by the generic path of the physics (AABB kernel broadphase
+    on the swept boxes, then a swept test per pair). Build it in Release to get meaningful numbers.
+**/
+namespace
+{
+    const std::size_t projectileCount = 10000;
+    const std::size_t stepCount = 20;
+    const float dt = 1.f / 120.f;
+
+    enum Kind {Player = 0, Ball, Sakura, Wall};
+
+    struct Body
+    {
+        kantan::Entity* entity;
+        sf::FloatRect box;
+        sf::Vector2f velocity;
+        unsigned int layers, mask;
+    };
+
+    unsigned int bit(Kind kind)
+    {
+        return 1u << kind;
+    }
+
+    // Same scene for both paths: balls collide with sakuras, the player and the wall.
+    std::vector<Body> createScene(std::vector<std::unique_ptr<kantan::Entity>>& entities)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> x(65.f, 641.f);
+        std::uniform_real_distribution<float> y(-20000.f, 640.f);
+
+        std::vector<Body> bodies;
+
+        for(std::size_t i(0) ; i < projectileCount ; ++i)
+        {
+            bool ball = i % 2 == 0;
+            entities.emplace_back(new kantan::Entity(ball ? "Ball" : "Sakura"));
+
+            if(ball)
+                bodies.push_back(Body{entities.back().get(), sf::FloatRect(x(rng), y(rng), 64.f, 64.f), sf::Vector2f(0.f, 300.f), bit(Ball), bit(Player) | bit(Sakura) | bit(Wall)});
+            else
+                bodies.push_back(Body{entities.back().get(), sf::FloatRect(x(rng), y(rng), 16.f, 16.f), sf::Vector2f(0.f, -300.f), bit(Sakura), bit(Ball)});
+        }
+
+        entities.emplace_back(new kantan::Entity("Player"));
+        bodies.push_back(Body{entities.back().get(), sf::FloatRect(300.f, 640.f, 48.f, 48.f), sf::Vector2f(250.f, 0.f), bit(Player), bit(Ball) | bit(Wall)});
+
+        entities.emplace_back(new kantan::Entity("Box"));
+        bodies.push_back(Body{entities.back().get(), sf::FloatRect(64.f, 704.f, 640.f, 64.f), sf::Vector2f(0.f, 0.f), bit(Wall), bit(Ball) | bit(Player)});
+
+        return bodies;
+    }
+
+    // Generic path: every body against the swept boxes of all the others.
+    std::size_t stepGeneric(std::vector<Body>& bodies, const kantan::AabbKernel& kernel, kantan::AabbArrays& sweeps, std::vector<unsigned int>& candidates)
+    {
+        std::size_t contacts = 0;
+
+        sweeps.clear();
+        for(const Body& body : bodies)
+        {
+            sf::Vector2f movement = body.velocity * dt;
+            sweeps.push(sf::FloatRect(body.box.left + std::min(0.f, movement.x), body.box.top + std::min(0.f, movement.y),
+                                      body.box.width + std::abs(movement.x), body.box.height + std::abs(movement.y)), body.layers);
+        }
+
+        for(unsigned int fst(0) ; fst < bodies.size() ; ++fst)
+        {
+            if(bodies[fst].velocity == sf::Vector2f(0.f, 0.f))
+                continue;
+
+            candidates.clear();
+            kernel.findIntersections(sf::FloatRect(sweeps.minX[fst], sweeps.minY[fst], sweeps.maxX[fst] - sweeps.minX[fst], sweeps.maxY[fst] - sweeps.minY[fst]),
+                                     sweeps, candidates, bodies[fst].mask);
+
+            for(unsigned int snd : candidates)
+            {
+                // Two movers only once.
+                bool sndMoves = bodies[snd].velocity != sf::Vector2f(0.f, 0.f);
+                if(snd == fst || (sndMoves && snd < fst) || (bodies[fst].layers & bodies[snd].mask) == 0)
+                    continue;
+
+                kantan::SweepHit hit;
+                if(kantan::sweepAabb(bodies[fst].box, bodies[fst].velocity * dt, bodies[snd].box, bodies[snd].velocity * dt, hit))
+                    ++contacts;
+            }
+        }
+
+        for(Body& body : bodies)
+        {
+            body.box.left += body.velocity.x * dt;
+            body.box.top += body.velocity.y * dt;
+        }
+
+        return contacts;
+    }
+}
+
+int main()
+{
+    std::vector<std::unique_ptr<kantan::Entity>> entities;
+
+    // Generic path.
+    std::vector<Body> bodies = createScene(entities);
+    kantan::AabbKernel kernel;
+    kantan::AabbArrays sweeps;
+    std::vector<unsigned int> candidates;
+
+    std::size_t genericContacts = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for(std::size_t step(0) ; step < stepCount ; ++step)
+        genericContacts += stepGeneric(bodies, kernel, sweeps, candidates);
+
+    std::chrono::duration<double, std::milli> generic = std::chrono::steady_clock::now() - start;
+
+    // Packed path: the projectiles in the batch, the player and the wall as targets.
+    bodies = createScene(entities);
+    kantan::ProjectileBatch batch;
+    batch.setKind(Ball, sf::Vector2f(64.f, 64.f), bit(Ball), bit(Player) | bit(Sakura) | bit(Wall));
+    batch.setKind(Sakura, sf::Vector2f(16.f, 16.f), bit(Sakura), bit(Ball));
+
+    for(std::size_t i(0) ; i < projectileCount ; ++i)
+        batch.sync(bodies[i].entity, sf::Vector2f(bodies[i].box.left, bodies[i].box.top), bodies[i].velocity.y, bodies[i].layers == bit(Ball) ? Ball : Sakura);
+
+    std::vector<kantan::ProjectileTarget> targets;
+    std::vector<kantan::ProjectileContact> contacts;
+
+    start = std::chrono::steady_clock::now();
+
+    for(std::size_t step(0) ; step < stepCount ; ++step)
+    {
+        targets.clear();
+        for(std::size_t i(projectileCount) ; i < bodies.size() ; ++i)
+        {
+            targets.push_back(kantan::ProjectileTarget{bodies[i].entity, bodies[i].box, bodies[i].velocity * dt, bodies[i].layers, bodies[i].mask});
+            bodies[i].box.left += bodies[i].velocity.x * dt;
+            bodies[i].box.top += bodies[i].velocity.y * dt;
+        }
+
+        batch.step(dt, targets, contacts);
+    }
+
+    std::chrono::duration<double, std::milli> packed = std::chrono::steady_clock::now() - start;
+
+    std::cout << projectileCount << " projectiles, " << stepCount << " steps" << std::endl;
+    std::cout << "Generic: " << generic.count() / stepCount << " ms/step, " << genericContacts << " contacts" << std::endl;
+    std::cout << "Packed: " << packed.count() / stepCount << " ms/step, " << contacts.size() << " contacts"
+              << (contacts.size() == genericContacts ? "" : " (MISMATCH)") << std::endl;
+    std::cout << "Speedup: " << generic.count() / packed.count() << "x" << std::endl;
+
+    return 0;
+}
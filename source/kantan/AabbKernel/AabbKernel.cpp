@@ -0,0 +1,281 @@
+#include "AabbKernel.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define KANTAN_AABB_X86
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define KANTAN_AABB_TARGET(isa)
+    #else
+        #define KANTAN_AABB_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+namespace kantan
+{
+    namespace
+    {
+        // Pushes the index of every bit set in the mask, lowest first.
+        inline void appendHits(unsigned int mask, unsigned int base, std::vector<unsigned int>& hits)
+        {
+            for(unsigned int bit(0) ; mask != 0 ; ++bit, mask >>= 1)
+            {
+                if(mask & 1u)
+                    hits.push_back(base + bit);
+            }
+        }
+
+        // Plain loop, also used for the tail of the vectorized versions.
+        void findScalar(float qMinX, float qMinY, float qMaxX, float qMaxY, unsigned int qMask, const AabbArrays& boxes, std::size_t begin, std::vector<unsigned int>& hits)
+        {
+            const std::size_t n = boxes.size();
+
+            for(std::size_t i(begin) ; i < n ; ++i)
+            {
+                if((boxes.layers[i] & qMask) == 0)
+                    continue;
+
+                if(qMinX < boxes.maxX[i] && boxes.minX[i] < qMaxX && qMinY < boxes.maxY[i] && boxes.minY[i] < qMaxY)
+                    hits.push_back(static_cast<unsigned int>(i));
+            }
+        }
+
+        #ifdef KANTAN_AABB_X86
+        KANTAN_AABB_TARGET("sse2")
+        void findSSE(float qMinX, float qMinY, float qMaxX, float qMaxY, unsigned int qMask, const AabbArrays& boxes, std::vector<unsigned int>& hits)
+        {
+            const std::size_t n = boxes.size();
+            const __m128 minX = _mm_set1_ps(qMinX), minY = _mm_set1_ps(qMinY);
+            const __m128 maxX = _mm_set1_ps(qMaxX), maxY = _mm_set1_ps(qMaxY);
+            const __m128i layerMask = _mm_set1_epi32(static_cast<int>(qMask)), zero = _mm_setzero_si128();
+
+            std::size_t i(0);
+            for( ; i + 4 <= n ; i += 4)
+            {
+                // Boxes on none of the layers are rejected with the geometry.
+                __m128i layers = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&boxes.layers[i])), layerMask);
+                __m128 other = _mm_castsi128_ps(_mm_cmpeq_epi32(layers, zero));
+
+                __m128 x = _mm_and_ps(_mm_cmplt_ps(minX, _mm_loadu_ps(&boxes.maxX[i])), _mm_cmplt_ps(_mm_loadu_ps(&boxes.minX[i]), maxX));
+                __m128 y = _mm_and_ps(_mm_cmplt_ps(minY, _mm_loadu_ps(&boxes.maxY[i])), _mm_cmplt_ps(_mm_loadu_ps(&boxes.minY[i]), maxY));
+                int mask = _mm_movemask_ps(_mm_andnot_ps(other, _mm_and_ps(x, y)));
+
+                if(mask != 0)
+                    appendHits(static_cast<unsigned int>(mask), static_cast<unsigned int>(i), hits);
+            }
+
+            findScalar(qMinX, qMinY, qMaxX, qMaxY, qMask, boxes, i, hits);
+        }
+
+        KANTAN_AABB_TARGET("avx2")
+        void findAVX2(float qMinX, float qMinY, float qMaxX, float qMaxY, unsigned int qMask, const AabbArrays& boxes, std::vector<unsigned int>& hits)
+        {
+            const std::size_t n = boxes.size();
+            const __m256 minX = _mm256_set1_ps(qMinX), minY = _mm256_set1_ps(qMinY);
+            const __m256 maxX = _mm256_set1_ps(qMaxX), maxY = _mm256_set1_ps(qMaxY);
+            const __m256i layerMask = _mm256_set1_epi32(static_cast<int>(qMask)), zero = _mm256_setzero_si256();
+
+            std::size_t i(0);
+            for( ; i + 8 <= n ; i += 8)
+            {
+                // Boxes on none of the layers are rejected with the geometry.
+                __m256i layers = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&boxes.layers[i])), layerMask);
+                __m256 other = _mm256_castsi256_ps(_mm256_cmpeq_epi32(layers, zero));
+
+                __m256 x = _mm256_and_ps(_mm256_cmp_ps(minX, _mm256_loadu_ps(&boxes.maxX[i]), _CMP_LT_OQ),
+                                         _mm256_cmp_ps(_mm256_loadu_ps(&boxes.minX[i]), maxX, _CMP_LT_OQ));
+                __m256 y = _mm256_and_ps(_mm256_cmp_ps(minY, _mm256_loadu_ps(&boxes.maxY[i]), _CMP_LT_OQ),
+                                         _mm256_cmp_ps(_mm256_loadu_ps(&boxes.minY[i]), maxY, _CMP_LT_OQ));
+                int mask = _mm256_movemask_ps(_mm256_andnot_ps(other, _mm256_and_ps(x, y)));
+
+                if(mask != 0)
+                    appendHits(static_cast<unsigned int>(mask), static_cast<unsigned int>(i), hits);
+            }
+
+            findScalar(qMinX, qMinY, qMaxX, qMaxY, qMask, boxes, i, hits);
+        }
+
+        KANTAN_AABB_TARGET("avx512f")
+        void findAVX512(float qMinX, float qMinY, float qMaxX, float qMaxY, unsigned int qMask, const AabbArrays& boxes, std::vector<unsigned int>& hits)
+        {
+            const std::size_t n = boxes.size();
+            const __m512 minX = _mm512_set1_ps(qMinX), minY = _mm512_set1_ps(qMinY);
+            const __m512 maxX = _mm512_set1_ps(qMaxX), maxY = _mm512_set1_ps(qMaxY);
+            const __m512i layerMask = _mm512_set1_epi32(static_cast<int>(qMask));
+
+            std::size_t i(0);
+            for( ; i + 16 <= n ; i += 16)
+            {
+                // Boxes on none of the layers are rejected with the geometry.
+                __mmask16 mask = _mm512_test_epi32_mask(_mm512_loadu_si512(&boxes.layers[i]), layerMask);
+                mask = _mm512_mask_cmp_ps_mask(mask, minX, _mm512_loadu_ps(&boxes.maxX[i]), _CMP_LT_OQ);
+                mask = _mm512_mask_cmp_ps_mask(mask, _mm512_loadu_ps(&boxes.minX[i]), maxX, _CMP_LT_OQ);
+                mask = _mm512_mask_cmp_ps_mask(mask, minY, _mm512_loadu_ps(&boxes.maxY[i]), _CMP_LT_OQ);
+                mask = _mm512_mask_cmp_ps_mask(mask, _mm512_loadu_ps(&boxes.minY[i]), maxY, _CMP_LT_OQ);
+
+                if(mask != 0)
+                    appendHits(static_cast<unsigned int>(mask), static_cast<unsigned int>(i), hits);
+            }
+
+            findScalar(qMinX, qMinY, qMaxX, qMaxY, qMask, boxes, i, hits);
+        }
+        #endif // KANTAN_AABB_X86
+    }
+
+    /// Levels.
+    SimdLevel detectSimdLevel()
+    {
+        #if defined(KANTAN_AABB_X86) && defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            int maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            bool sse2 = (info[3] & (1 << 26)) != 0;
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+
+            bool avx2 = false, avx512 = false;
+            if(maxLeaf >= 7)
+            {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+                avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+            }
+
+            if(avx512)
+                return SimdLevel::AVX512;
+            if(avx2)
+                return SimdLevel::AVX2;
+            if(sse2)
+                return SimdLevel::SSE;
+        #elif defined(KANTAN_AABB_X86)
+            __builtin_cpu_init();
+
+            if(__builtin_cpu_supports("avx512f"))
+                return SimdLevel::AVX512;
+            if(__builtin_cpu_supports("avx2"))
+                return SimdLevel::AVX2;
+            if(__builtin_cpu_supports("sse2"))
+                return SimdLevel::SSE;
+        #endif
+
+        return SimdLevel::Scalar;
+    }
+
+    bool isSimdLevelSupported(SimdLevel level)
+    {
+        static const SimdLevel best = detectSimdLevel();
+        return level <= best;
+    }
+
+    const char* getSimdLevelName(SimdLevel level)
+    {
+        switch(level)
+        {
+            case SimdLevel::SSE:
+                return "SSE";
+            case SimdLevel::AVX2:
+                return "AVX2";
+            case SimdLevel::AVX512:
+                return "AVX-512";
+            case SimdLevel::Scalar:
+            default:
+                return "Scalar";
+        }
+    }
+
+    /// Arrays.
+    void AabbArrays::clear()
+    {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+        layers.clear();
+    }
+
+    void AabbArrays::reserve(std::size_t n)
+    {
+        minX.reserve(n);
+        minY.reserve(n);
+        maxX.reserve(n);
+        maxY.reserve(n);
+        layers.reserve(n);
+    }
+
+    std::size_t AabbArrays::push(const sf::FloatRect& box, unsigned int boxLayers)
+    {
+        minX.push_back(0.f);
+        minY.push_back(0.f);
+        maxX.push_back(0.f);
+        maxY.push_back(0.f);
+        layers.push_back(boxLayers);
+
+        set(minX.size() - 1, box);
+        return minX.size() - 1;
+    }
+
+    void AabbArrays::set(std::size_t index, const sf::FloatRect& box)
+    {
+        // Rectangles with a negative size are allowed, like in sf::Rect.
+        minX[index] = std::min(box.left, box.left + box.width);
+        maxX[index] = std::max(box.left, box.left + box.width);
+        minY[index] = std::min(box.top, box.top + box.height);
+        maxY[index] = std::max(box.top, box.top + box.height);
+    }
+
+    std::size_t AabbArrays::size() const
+    {
+        return minX.size();
+    }
+
+    /// Ctor.
+    AabbKernel::AabbKernel()
+        : m_level(detectSimdLevel())
+    {}
+
+    AabbKernel::AabbKernel(SimdLevel level)
+        : m_level(isSimdLevelSupported(level) ? level : SimdLevel::Scalar)
+    {}
+
+    /// Level.
+    SimdLevel AabbKernel::getLevel() const
+    {
+        return m_level;
+    }
+
+    /// Queries.
+    std::size_t AabbKernel::findIntersections(const sf::FloatRect& box, const AabbArrays& boxes, std::vector<unsigned int>& hits, unsigned int mask) const
+    {
+        const std::size_t before = hits.size();
+
+        float qMinX = std::min(box.left, box.left + box.width);
+        float qMaxX = std::max(box.left, box.left + box.width);
+        float qMinY = std::min(box.top, box.top + box.height);
+        float qMaxY = std::max(box.top, box.top + box.height);
+
+        switch(m_level)
+        {
+            #ifdef KANTAN_AABB_X86
+            case SimdLevel::AVX512:
+                findAVX512(qMinX, qMinY, qMaxX, qMaxY, mask, boxes, hits);
+                break;
+            case SimdLevel::AVX2:
+                findAVX2(qMinX, qMinY, qMaxX, qMaxY, mask, boxes, hits);
+                break;
+            case SimdLevel::SSE:
+                findSSE(qMinX, qMinY, qMaxX, qMaxY, mask, boxes, hits);
+                break;
+            #endif
+            default:
+                findScalar(qMinX, qMinY, qMaxX, qMaxY, mask, boxes, 0, hits);
+                break;
+        }
+
+        return hits.size() - before;
+    }
+} // namespace kantan.
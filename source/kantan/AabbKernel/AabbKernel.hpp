@@ -0,0 +1,82 @@
+#ifndef KANTAN_AABB_KERNEL
+#define KANTAN_AABB_KERNEL
+
+#include <SFML/Graphics.hpp>
+
+#include <vector>
+#include <cstddef>
+
+namespace kantan
+{
+    /**
+        SimdLevel enum.
+        Instruction sets the AABB kernel can run on, from the slowest to the fastest.
+    **/
+    enum class SimdLevel {Scalar = 0, SSE, AVX2, AVX512};
+
+    // Returns the best level supported by both the build and the running CPU.
+    SimdLevel detectSimdLevel();
+
+    // Returns true if the level can run on this machine.
+    bool isSimdLevelSupported(SimdLevel level);
+
+    // Returns a printable name for the level.
+    const char* getSimdLevelName(SimdLevel level);
+
+    /**
+        AabbArrays class.
+        Axis-aligned boxes stored as a structure of arrays (min x, min y, max x, max y),
+        with the collision layers bitfield of each box.
+    **/
+    class AabbArrays
+    {
+        public:
+            // Removes all the boxes.
+            void clear();
+
+            // Reserves memory for n boxes.
+            void reserve(std::size_t n);
+
+            // Adds a box and returns its index. By default a box is on every layer.
+            std::size_t push(const sf::FloatRect& box, unsigned int layers = ~0u);
+
+            // Overwrites the box at the given index.
+            void set(std::size_t index, const sf::FloatRect& box);
+
+            // Number of boxes.
+            std::size_t size() const;
+
+            // Bounds.
+            std::vector<float> minX, minY, maxX, maxY;
+
+            // Layers.
+            std::vector<unsigned int> layers;
+    };
+
+    /**
+        AabbKernel class.
+        Tests one box against a whole AabbArrays batch, 4 (SSE), 8 (AVX2) or 16 (AVX-512) boxes per instruction.
+        The intersection rule is the one of sf::FloatRect::intersects (touching edges do not intersect).
+    **/
+    class AabbKernel
+    {
+        public:
+            // Ctor, picks the best level available at runtime.
+            AabbKernel();
+
+            // Ctor, forces a level (falls back to scalar if the level is not supported).
+            explicit AabbKernel(SimdLevel level);
+
+            // Level used.
+            SimdLevel getLevel() const;
+
+            // Appends the indices of the boxes intersecting the given one to hits, in increasing order.
+            // Only the boxes on one of the layers of the mask are tested. Returns the number of hits found.
+            std::size_t findIntersections(const sf::FloatRect& box, const AabbArrays& boxes, std::vector<unsigned int>& hits, unsigned int mask = ~0u) const;
+
+        protected:
+            SimdLevel m_level;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_AABB_KERNEL
@@ -0,0 +1,56 @@
+#include "CollisionMatrix.hpp"
+
+namespace kantan
+{
+    /// Ctor.
+    CollisionMatrix::CollisionMatrix()
+    {
+        for(unsigned int i(0) ; i < LayerCount ; ++i)
+            m_masks[i] = 0;
+    }
+
+    /// Interactions.
+    void CollisionMatrix::setInteraction(unsigned int layerA, unsigned int layerB, bool interact)
+    {
+        if(layerA >= LayerCount || layerB >= LayerCount)
+            return;
+
+        if(interact)
+        {
+            m_masks[layerA] |= getBit(layerB);
+            m_masks[layerB] |= getBit(layerA);
+        }
+        else
+        {
+            m_masks[layerA] &= ~getBit(layerB);
+            m_masks[layerB] &= ~getBit(layerA);
+        }
+    }
+
+    bool CollisionMatrix::interacts(unsigned int layerA, unsigned int layerB) const
+    {
+        return (getMask(layerA) & getBit(layerB)) != 0;
+    }
+
+    /// Masks.
+    unsigned int CollisionMatrix::getMask(unsigned int layer) const
+    {
+        if(layer >= LayerCount)
+            return 0;
+
+        return m_masks[layer];
+    }
+
+    unsigned int CollisionMatrix::getBit(unsigned int layer)
+    {
+        if(layer >= LayerCount)
+            return 0;
+
+        return 1u << layer;
+    }
+
+    bool CollisionMatrix::canCollide(unsigned int layersA, unsigned int maskA, unsigned int layersB, unsigned int maskB)
+    {
+        return (layersA & maskB) != 0 && (layersB & maskA) != 0;
+    }
+} // namespace kantan.
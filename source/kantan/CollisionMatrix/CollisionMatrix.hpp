@@ -0,0 +1,41 @@
+#ifndef KANTAN_COLLISION_MATRIX
+#define KANTAN_COLLISION_MATRIX
+
+namespace kantan
+{
+    /**
+        CollisionMatrix class.
+        Tells which collision layers interact with each other, and gives the mask of each layer.
+        Layers are numbered from 0 to 31, a hitbox on the layer n has the bit (1 << n) set.
+    **/
+    class CollisionMatrix
+    {
+        public:
+            // Ctor, no layer interacts.
+            CollisionMatrix();
+
+            // Makes two layers interact or not, both ways.
+            void setInteraction(unsigned int layerA, unsigned int layerB, bool interact = true);
+
+            // Returns true if the two layers interact.
+            bool interacts(unsigned int layerA, unsigned int layerB) const;
+
+            // Returns the bitfield of the layers interacting with the given one.
+            unsigned int getMask(unsigned int layer) const;
+
+            // Returns the bit of a layer.
+            static unsigned int getBit(unsigned int layer);
+
+            // Returns true if two hitboxes (layers bitfield and mask) can collide.
+            static bool canCollide(unsigned int layersA, unsigned int maskA, unsigned int layersB, unsigned int maskB);
+
+            // Number of layers.
+            static const unsigned int LayerCount = 32;
+
+        protected:
+            // Mask of each layer.
+            unsigned int m_masks[LayerCount];
+    };
+} // namespace kantan.
+
+#endif // KANTAN_COLLISION_MATRIX
@@ -0,0 +1,88 @@
+#include "CollisionResponseRegistry.hpp"
+#include "../Entity/Entity.hpp"
+
+namespace kantan
+{
+    /// Ctor.
+    CollisionResponseRegistry::CollisionResponseRegistry()
+        : m_kindCount(0)
+    {}
+
+    /// Kinds.
+    unsigned int CollisionResponseRegistry::registerKind(const std::string& name)
+    {
+        auto found = m_kinds.find(name);
+
+        if(found != m_kinds.end())
+            return found->second;
+
+        // Grow the table, keeping the existing cells.
+        unsigned int count = m_kindCount + 1;
+        std::vector<Slot> table(count * count, Slot{-1, false});
+
+        for(unsigned int i(0) ; i < m_kindCount ; ++i)
+            for(unsigned int j(0) ; j < m_kindCount ; ++j)
+                table[i * count + j] = m_table[i * m_kindCount + j];
+
+        m_table.swap(table);
+        m_kinds[name] = m_kindCount;
+
+        return m_kindCount++;
+    }
+
+    unsigned int CollisionResponseRegistry::getKindCount() const
+    {
+        return m_kindCount;
+    }
+
+    unsigned int CollisionResponseRegistry::getKind(const std::string& name) const
+    {
+        auto found = m_kinds.find(name);
+
+        if(found == m_kinds.end())
+            return Entity::NoKind;
+
+        return found->second;
+    }
+
+    void CollisionResponseRegistry::assignKind(Entity* entity) const
+    {
+        entity->setKind(getKind(entity->getName()));
+    }
+
+    /// Handlers.
+    void CollisionResponseRegistry::registerHandler(const std::string& firstKind, const std::string& secondKind, Handler handler)
+    {
+        unsigned int first = registerKind(firstKind);
+        unsigned int second = registerKind(secondKind);
+
+        int index = static_cast<int>(m_handlers.size());
+        m_handlers.push_back(handler);
+
+        // Both orders lead to the same handler.
+        m_table[first * m_kindCount + second] = Slot{index, false};
+        m_table[second * m_kindCount + first] = Slot{index, first != second};
+    }
+
+    /// Dispatch.
+    bool CollisionResponseRegistry::dispatch(Entity* a, Entity* b, std::queue<Event*>& eventQueue) const
+    {
+        unsigned int kindA = a->getKind();
+        unsigned int kindB = b->getKind();
+
+        if(kindA >= m_kindCount || kindB >= m_kindCount)
+            return false;
+
+        const Slot& slot = m_table[kindA * m_kindCount + kindB];
+
+        if(slot.handler < 0)
+            return false;
+
+        if(slot.swap)
+            m_handlers[slot.handler](b, a, eventQueue);
+        else
+            m_handlers[slot.handler](a, b, eventQueue);
+
+        return true;
+    }
+} // namespace kantan.
@@ -0,0 +1,67 @@
+#ifndef KANTAN_COLLISION_RESPONSE_REGISTRY
+#define KANTAN_COLLISION_RESPONSE_REGISTRY
+
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    class Entity;
+    class Event;
+
+    /**
+        CollisionResponseRegistry class.
+        Handlers of the collisions between two kinds of entities (their names), for an unordered pair of kinds.
+        Dispatching is a lookup in a flat kinds x kinds table, with the kind indices the entities were given once by
+        assignKind: the handler always gets the entities in the order it was registered with, whatever the order of the contact.
+    **/
+    class CollisionResponseRegistry
+    {
+        public:
+            // Handler, called with an entity of each kind in the registration order.
+            typedef std::function<void(Entity* first, Entity* second, std::queue<Event*>& eventQueue)> Handler;
+
+            // Ctor.
+            CollisionResponseRegistry();
+
+            // Returns the index of a kind, registering it if needed.
+            unsigned int registerKind(const std::string& name);
+
+            // Returns the index of a kind, Entity::NoKind if unknown.
+            unsigned int getKind(const std::string& name) const;
+
+            // Registers the handler of the pair of kinds (replaces the previous one).
+            void registerHandler(const std::string& firstKind, const std::string& secondKind, Handler handler);
+
+            // Gives an entity the index of its kind (its name), Entity::NoKind if it has no handler.
+            // The kinds must be registered before.
+            void assignKind(Entity* entity) const;
+
+            // Calls the handler of the pair of kinds of the entities if there is one, returns false otherwise.
+            bool dispatch(Entity* a, Entity* b, std::queue<Event*>& eventQueue) const;
+
+            // Number of kinds.
+            unsigned int getKindCount() const;
+
+        protected:
+            // A cell of the table.
+            struct Slot
+            {
+                // Index of the handler, -1 if none.
+                int handler;
+
+                // True if the entities must be swapped before calling it.
+                bool swap;
+            };
+
+            std::unordered_map<std::string, unsigned int> m_kinds;
+            std::vector<Slot> m_table;
+            std::vector<Handler> m_handlers;
+            unsigned int m_kindCount;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_COLLISION_RESPONSE_REGISTRY
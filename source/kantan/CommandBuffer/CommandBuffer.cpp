@@ -0,0 +1,284 @@
+#include "CommandBuffer.hpp"
+#include "../RenderQueue/RenderQueue.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace kantan
+{
+    namespace
+    {
+        // First bytes of a saved buffer: "KCB" and the version.
+        const char FileMagic[4] = {'K', 'C', 'B', 1};
+
+        template<typename T>
+        void writeArray(std::ofstream& file, const std::vector<T>& values)
+        {
+            std::uint32_t size = static_cast<std::uint32_t>(values.size());
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+
+            if(size != 0)
+                file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(sizeof(T) * size));
+        }
+
+        template<typename T>
+        bool readArray(std::ifstream& file, std::vector<T>& values)
+        {
+            std::uint32_t size = 0;
+            if(!file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+                return false;
+
+            values.resize(size);
+            return size == 0 || file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(sizeof(T) * size));
+        }
+    }
+
+    /// Resources.
+    void RenderResources::addTexture(std::uint32_t id, const sf::Texture& texture)
+    {
+        m_textures[id] = &texture;
+        m_textureIds[&texture] = id;
+    }
+
+    void RenderResources::addFont(std::uint32_t id, const sf::Font& font)
+    {
+        m_fonts[id] = &font;
+        m_fontIds[&font] = id;
+    }
+
+    void RenderResources::addDrawable(std::uint32_t id, const sf::Drawable& drawable)
+    {
+        m_drawables[id] = &drawable;
+    }
+
+    const sf::Texture* RenderResources::getTexture(std::uint32_t id) const
+    {
+        auto found = m_textures.find(id);
+        return found != m_textures.end() ? found->second : nullptr;
+    }
+
+    const sf::Font* RenderResources::getFont(std::uint32_t id) const
+    {
+        auto found = m_fonts.find(id);
+        return found != m_fonts.end() ? found->second : nullptr;
+    }
+
+    const sf::Drawable* RenderResources::getDrawable(std::uint32_t id) const
+    {
+        auto found = m_drawables.find(id);
+        return found != m_drawables.end() ? found->second : nullptr;
+    }
+
+    std::uint32_t RenderResources::getTextureId(const sf::Texture* texture) const
+    {
+        if(!texture)
+            return NoResource;
+
+        auto found = m_textureIds.find(texture);
+        if(found == m_textureIds.end())
+            throw std::runtime_error("RenderResources::getTextureId - Texture not registered");
+
+        return found->second;
+    }
+
+    std::uint32_t RenderResources::getFontId(const sf::Font* font) const
+    {
+        if(!font)
+            return NoResource;
+
+        auto found = m_fontIds.find(font);
+        if(found == m_fontIds.end())
+            throw std::runtime_error("RenderResources::getFontId - Font not registered");
+
+        return found->second;
+    }
+
+    /// Ctor.
+    CommandBuffer::CommandBuffer(const RenderResources* resources)
+        : m_resources(resources)
+    {}
+
+    void CommandBuffer::setResources(const RenderResources* resources)
+    {
+        m_resources = resources;
+    }
+
+    /// Recording.
+    void CommandBuffer::draw(const sf::Sprite& sprite, unsigned int layer, std::uint32_t depth)
+    {
+        if(!m_resources)
+            throw std::runtime_error("CommandBuffer::draw - No resources to record a sprite");
+
+        RenderCommand command = RenderCommand();
+        command.type = RenderCommand::Vertices;
+        command.layer = layer;
+        command.depth = depth;
+        command.resource = m_resources->getTextureId(sprite.getTexture());
+        command.first = static_cast<std::uint32_t>(m_vertices.size());
+        command.count = 4;
+        command.primitive = sf::Quads;
+
+        appendSpriteQuad(sprite, m_vertices);
+        m_commands.push_back(command);
+    }
+
+    void CommandBuffer::draw(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, std::uint32_t texture, unsigned int layer, std::uint32_t depth)
+    {
+        if(count == 0)
+            return;
+
+        RenderCommand command = RenderCommand();
+        command.type = RenderCommand::Vertices;
+        command.layer = layer;
+        command.depth = depth;
+        command.resource = texture;
+        command.first = static_cast<std::uint32_t>(m_vertices.size());
+        command.count = static_cast<std::uint32_t>(count);
+        command.primitive = type;
+
+        m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+        m_commands.push_back(command);
+    }
+
+    void CommandBuffer::draw(const sf::Text& text, unsigned int layer, std::uint32_t depth)
+    {
+        if(!m_resources)
+            throw std::runtime_error("CommandBuffer::draw - No resources to record a text");
+
+        const sf::String& string = text.getString();
+
+        RenderCommand command = RenderCommand();
+        command.type = RenderCommand::Text;
+        command.layer = layer;
+        command.depth = depth;
+        command.resource = m_resources->getFontId(text.getFont());
+        command.first = static_cast<std::uint32_t>(m_characters.size());
+        command.count = static_cast<std::uint32_t>(string.getSize());
+        command.characterSize = text.getCharacterSize();
+        command.style = text.getStyle();
+        command.x = text.getPosition().x;
+        command.y = text.getPosition().y;
+        command.color = text.getFillColor().toInteger();
+
+        for(std::size_t i(0) ; i < string.getSize() ; ++i)
+            m_characters.push_back(string[i]);
+
+        m_commands.push_back(command);
+    }
+
+    void CommandBuffer::drawResource(std::uint32_t drawable, unsigned int layer, std::uint32_t depth)
+    {
+        RenderCommand command = RenderCommand();
+        command.type = RenderCommand::Drawable;
+        command.layer = layer;
+        command.depth = depth;
+        command.resource = drawable;
+
+        m_commands.push_back(command);
+    }
+
+    void CommandBuffer::drawRectangle(const sf::FloatRect& rect, const sf::Color& color, unsigned int layer, std::uint32_t depth)
+    {
+        const sf::Vertex quad[4] =
+        {
+            sf::Vertex(sf::Vector2f(rect.left, rect.top), color),
+            sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), color),
+            sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), color),
+            sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), color)
+        };
+
+        draw(quad, 4, sf::Quads, RenderResources::NoResource, layer, depth);
+    }
+
+    void CommandBuffer::append(const CommandBuffer& other)
+    {
+        const std::uint32_t vertexOffset = static_cast<std::uint32_t>(m_vertices.size());
+        const std::uint32_t characterOffset = static_cast<std::uint32_t>(m_characters.size());
+
+        for(RenderCommand command : other.m_commands)
+        {
+            if(command.type == RenderCommand::Text)
+                command.first += characterOffset;
+            else if(command.type == RenderCommand::Vertices)
+                command.first += vertexOffset;
+
+            m_commands.push_back(command);
+        }
+
+        m_vertices.insert(m_vertices.end(), other.m_vertices.begin(), other.m_vertices.end());
+        m_characters.insert(m_characters.end(), other.m_characters.begin(), other.m_characters.end());
+    }
+
+    void CommandBuffer::clear()
+    {
+        m_commands.clear();
+        m_vertices.clear();
+        m_characters.clear();
+    }
+
+    /// Getters.
+    const std::vector<RenderCommand>& CommandBuffer::getCommands() const
+    {
+        return m_commands;
+    }
+
+    const std::vector<sf::Vertex>& CommandBuffer::getVertices() const
+    {
+        return m_vertices;
+    }
+
+    const std::vector<sf::Uint32>& CommandBuffer::getCharacters() const
+    {
+        return m_characters;
+    }
+
+    /// Files.
+    void CommandBuffer::saveToFile(const std::string& filename) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("CommandBuffer::saveToFile - Failed to open " + filename);
+
+        file.write(FileMagic, sizeof(FileMagic));
+        writeArray(file, m_commands);
+        writeArray(file, m_vertices);
+        writeArray(file, m_characters);
+
+        if(!file)
+            throw std::runtime_error("CommandBuffer::saveToFile - Failed to write " + filename);
+    }
+
+    void CommandBuffer::loadFromFile(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if(!file)
+            throw std::runtime_error("CommandBuffer::loadFromFile - Failed to open " + filename);
+
+        char magic[sizeof(FileMagic)];
+        if(!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), FileMagic))
+            throw std::runtime_error("CommandBuffer::loadFromFile - Not a command buffer: " + filename);
+
+        std::vector<RenderCommand> commands;
+        std::vector<sf::Vertex> vertices;
+        std::vector<sf::Uint32> characters;
+
+        if(!readArray(file, commands) || !readArray(file, vertices) || !readArray(file, characters))
+            throw std::runtime_error("CommandBuffer::loadFromFile - Truncated file " + filename);
+
+        // Every range must be in the arrays read.
+        for(const RenderCommand& command : commands)
+        {
+            if(command.type > RenderCommand::Drawable)
+                throw std::runtime_error("CommandBuffer::loadFromFile - Invalid command in " + filename);
+
+            std::size_t size = command.type == RenderCommand::Text ? characters.size() : vertices.size();
+            if(command.type != RenderCommand::Drawable && static_cast<std::size_t>(command.first) + command.count > size)
+                throw std::runtime_error("CommandBuffer::loadFromFile - Invalid command in " + filename);
+        }
+
+        m_commands.swap(commands);
+        m_vertices.swap(vertices);
+        m_characters.swap(characters);
+    }
+} // namespace kantan.
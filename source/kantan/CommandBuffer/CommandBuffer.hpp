@@ -0,0 +1,132 @@
+#ifndef KANTAN_COMMAND_BUFFER
+#define KANTAN_COMMAND_BUFFER
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        RenderResources class.
+        Textures, fonts and drawables (static geometry) referenced by id in the render commands,
+        so a command stream holds no pointer.
+        Filled before recording, then only read: several threads can record with the same resources.
+    **/
+    class RenderResources
+    {
+        public:
+            // Id of no resource.
+            static const std::uint32_t NoResource = 0xFFFFFFFF;
+
+            // Registers a texture, a font or a drawable under an id. The resource must outlive the resources.
+            void addTexture(std::uint32_t id, const sf::Texture& texture);
+            void addFont(std::uint32_t id, const sf::Font& font);
+            void addDrawable(std::uint32_t id, const sf::Drawable& drawable);
+
+            // Resource of an id, nullptr if none is registered.
+            const sf::Texture* getTexture(std::uint32_t id) const;
+            const sf::Font* getFont(std::uint32_t id) const;
+            const sf::Drawable* getDrawable(std::uint32_t id) const;
+
+            // Id of a resource (NoResource for nullptr), throws if it is not registered.
+            std::uint32_t getTextureId(const sf::Texture* texture) const;
+            std::uint32_t getFontId(const sf::Font* font) const;
+
+        protected:
+            std::unordered_map<std::uint32_t, const sf::Texture*> m_textures;
+            std::unordered_map<std::uint32_t, const sf::Font*> m_fonts;
+            std::unordered_map<std::uint32_t, const sf::Drawable*> m_drawables;
+            std::unordered_map<const sf::Texture*, std::uint32_t> m_textureIds;
+            std::unordered_map<const sf::Font*, std::uint32_t> m_fontIds;
+    };
+
+    /**
+        RenderCommand struct.
+        One recorded draw: vertices (a range of the buffer vertices), a text (a range of the buffer characters)
+        or a drawable of the resources.
+        Only 32-bit fields, so the commands are saved as they are.
+    **/
+    struct RenderCommand
+    {
+        enum Type : std::uint32_t {Vertices = 0, Text, Drawable};
+
+        std::uint32_t type;
+        std::uint32_t layer, depth;
+
+        // Texture of the vertices, font of the text, or the drawable.
+        std::uint32_t resource;
+
+        // Range of the vertices or of the characters.
+        std::uint32_t first, count;
+
+        // Vertices: sf::PrimitiveType.
+        std::uint32_t primitive;
+
+        // Text: size, sf::Text::Style, position and fill color (sf::Color::toInteger).
+        std::uint32_t characterSize, style;
+        float x, y;
+        std::uint32_t color;
+    };
+
+    /**
+        CommandBuffer class.
+        Draws recorded as plain data (the vertices and the strings are copied) instead of being sent to a window,
+        then executed by a RenderBackend. Nothing is drawn while recording, so a buffer can be filled by any thread
+        and appended to the frame one; a frame can also be saved and replayed without the game.
+    **/
+    class CommandBuffer
+    {
+        public:
+            // Ctor, the resources give the ids of the textures and the fonts recorded.
+            explicit CommandBuffer(const RenderResources* resources = nullptr);
+
+            // Sets the resources.
+            void setResources(const RenderResources* resources);
+
+            // Records the quad of a sprite.
+            void draw(const sf::Sprite& sprite, unsigned int layer, std::uint32_t depth = 0);
+
+            // Records vertices, with a texture id (NoResource for none). Nothing is recorded for 0 vertices.
+            void draw(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, std::uint32_t texture, unsigned int layer, std::uint32_t depth = 0);
+
+            // Records a text: its font, string, character size, style, fill color and position (its origin, scale,
+            // rotation and outline are not kept).
+            void draw(const sf::Text& text, unsigned int layer, std::uint32_t depth = 0);
+
+            // Records a drawable of the resources, which is not copied: its state is the one at execution.
+            void drawResource(std::uint32_t drawable, unsigned int layer, std::uint32_t depth = 0);
+
+            // Records a rectangle filled with a color.
+            void drawRectangle(const sf::FloatRect& rect, const sf::Color& color, unsigned int layer, std::uint32_t depth = 0);
+
+            // Appends the commands of another buffer.
+            void append(const CommandBuffer& other);
+
+            // Removes all the commands.
+            void clear();
+
+            // Recorded data.
+            const std::vector<RenderCommand>& getCommands() const;
+            const std::vector<sf::Vertex>& getVertices() const;
+            const std::vector<sf::Uint32>& getCharacters() const;
+
+            // Saves the commands in a binary file, or replaces them by the ones of a file (throws on failure).
+            // The file is in the byte order of the machine.
+            void saveToFile(const std::string& filename) const;
+            void loadFromFile(const std::string& filename);
+
+        protected:
+            const RenderResources* m_resources;
+
+            std::vector<RenderCommand> m_commands;
+            std::vector<sf::Vertex> m_vertices;
+            std::vector<sf::Uint32> m_characters;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_COMMAND_BUFFER
@@ -0,0 +1,137 @@
+#include "ContactCache.hpp"
+#include "../Entity/Entity.hpp"
+
+#include <algorithm>
+
+namespace kantan
+{
+    /// View.
+    ContactView::ContactView(const ContactEvent* begin, const ContactEvent* end)
+        : m_begin(begin)
+        , m_end(end)
+    {}
+
+    const ContactEvent* ContactView::begin() const
+    {
+        return m_begin;
+    }
+
+    const ContactEvent* ContactView::end() const
+    {
+        return m_end;
+    }
+
+    std::size_t ContactView::size() const
+    {
+        return static_cast<std::size_t>(m_end - m_begin);
+    }
+
+    bool ContactView::empty() const
+    {
+        return m_begin == m_end;
+    }
+
+    const ContactEvent& ContactView::operator[](std::size_t index) const
+    {
+        return m_begin[index];
+    }
+
+    /// Ctor.
+    ContactCache::ContactCache()
+        : m_step(0)
+    {}
+
+    /// Steps.
+    void ContactCache::beginStep()
+    {
+        ++m_step;
+
+        m_began.clear();
+        m_persisting.clear();
+        m_ended.clear();
+    }
+
+    void ContactCache::add(Entity* first, Entity* second)
+    {
+        unsigned int firstId = first->getId(), secondId = second->getId();
+        auto inserted = m_pairs.insert(std::make_pair(getKey(firstId, secondId), Entry{first, second, firstId, secondId, m_step}));
+        Entry& entry = inserted.first->second;
+
+        if(inserted.second)
+        {
+            m_began.push_back(ContactEvent{first, second, firstId, secondId, ContactEvent::Begin});
+        }
+        // Already added during this step.
+        else if(entry.step != m_step)
+        {
+            entry.first = first;
+            entry.second = second;
+            entry.firstId = firstId;
+            entry.secondId = secondId;
+            entry.step = m_step;
+
+            m_persisting.push_back(ContactEvent{first, second, firstId, secondId, ContactEvent::Persist});
+        }
+    }
+
+    void ContactCache::endStep()
+    {
+        for(auto it = m_pairs.begin() ; it != m_pairs.end() ;)
+        {
+            if(it->second.step != m_step)
+            {
+                const Entry& entry = it->second;
+                m_ended.push_back(ContactEvent{entry.first, entry.second, entry.firstId, entry.secondId, ContactEvent::End});
+                it = m_pairs.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        // The map order is not reliable, the ids are.
+        std::sort(m_ended.begin(), m_ended.end(), [](const ContactEvent& l, const ContactEvent& r)
+        {
+            if(l.firstId != r.firstId)
+                return l.firstId < r.firstId;
+            return l.secondId < r.secondId;
+        });
+    }
+
+    /// Views.
+    ContactView ContactCache::getBegan() const
+    {
+        return ContactView(m_began.data(), m_began.data() + m_began.size());
+    }
+
+    ContactView ContactCache::getPersisting() const
+    {
+        return ContactView(m_persisting.data(), m_persisting.data() + m_persisting.size());
+    }
+
+    ContactView ContactCache::getEnded() const
+    {
+        return ContactView(m_ended.data(), m_ended.data() + m_ended.size());
+    }
+
+    std::size_t ContactCache::getPairCount() const
+    {
+        return m_pairs.size();
+    }
+
+    void ContactCache::clear()
+    {
+        m_pairs.clear();
+        m_began.clear();
+        m_persisting.clear();
+        m_ended.clear();
+    }
+
+    /// Keys.
+    std::uint64_t ContactCache::getKey(unsigned int idA, unsigned int idB)
+    {
+        if(idA > idB)
+            std::swap(idA, idB);
+
+        return (static_cast<std::uint64_t>(idA) << 32) | idB;
+    }
+} // namespace kantan.
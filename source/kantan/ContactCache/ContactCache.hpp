@@ -0,0 +1,102 @@
+#ifndef KANTAN_CONTACT_CACHE
+#define KANTAN_CONTACT_CACHE
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    class Entity;
+
+    /**
+        ContactEvent struct.
+        A change (or not) of a contact between two entities.
+    **/
+    struct ContactEvent
+    {
+        enum Phase {Begin, Persist, End};
+
+        Entity* first;
+        Entity* second;
+        unsigned int firstId, secondId;
+        Phase phase;
+    };
+
+    /**
+        ContactView class.
+        Read-only range over contact events, it does not own nor copy them.
+        It stays valid until the next step of the cache it comes from.
+    **/
+    class ContactView
+    {
+        public:
+            // Ctor.
+            ContactView(const ContactEvent* begin = nullptr, const ContactEvent* end = nullptr);
+
+            // Range.
+            const ContactEvent* begin() const;
+            const ContactEvent* end() const;
+
+            std::size_t size() const;
+            bool empty() const;
+            const ContactEvent& operator[](std::size_t index) const;
+
+        protected:
+            const ContactEvent* m_begin;
+            const ContactEvent* m_end;
+    };
+
+    /**
+        ContactCache class.
+        Remembers the pairs of entities in contact from a step to the next, and classifies the contacts of a step
+        as beginning, persisting or ending. Pairs are unordered and keyed on the entities ids.
+        Ended contacts may involve entities removed since the last step, their pointers are not to be dereferenced then.
+    **/
+    class ContactCache
+    {
+        public:
+            // Ctor.
+            ContactCache();
+
+            // Starts a new step.
+            void beginStep();
+
+            // Adds a contact of the current step, in the order they happened.
+            void add(Entity* first, Entity* second);
+
+            // Ends the step: the pairs not added during it have ended.
+            void endStep();
+
+            // Contacts of the last step, by phase.
+            ContactView getBegan() const;
+            ContactView getPersisting() const;
+            ContactView getEnded() const;
+
+            // Number of pairs currently in contact.
+            std::size_t getPairCount() const;
+
+            // Forgets everything.
+            void clear();
+
+        protected:
+            // A pair in contact.
+            struct Entry
+            {
+                Entity* first;
+                Entity* second;
+                unsigned int firstId, secondId;
+                unsigned long step;
+            };
+
+            // Key of the unordered pair.
+            static std::uint64_t getKey(unsigned int idA, unsigned int idB);
+
+            std::unordered_map<std::uint64_t, Entry> m_pairs;
+            std::vector<ContactEvent> m_began, m_persisting, m_ended;
+            unsigned long m_step;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_CONTACT_CACHE
@@ -8,8 +8,9 @@ namespace kantan
 
 	/// Ctor.
 	Entity::Entity(std::string name)
-		: m_id(m_lastid + 1)
+		: m_id(++m_lastid)
 		, m_name(name)
+		, m_kind(NoKind)
 	{
 
 	}
@@ -25,6 +26,16 @@ namespace kantan
 		return m_name;
 	}
 
+	unsigned int Entity::getKind() const
+	{
+		return m_kind;
+	}
+
+	void Entity::setKind(unsigned int kind)
+	{
+		m_kind = kind;
+	}
+
 	/// Components.
 	void Entity::addComponent(Component* comp)
 	{
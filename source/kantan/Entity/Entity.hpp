@@ -14,6 +14,9 @@ namespace kantan
 	class Entity
 	{
 		public:
+			// Kind of no table.
+			static const unsigned int NoKind = 0xFFFFFFFF;
+
 			// Ctor.
 			Entity(std::string name);
 
@@ -21,6 +24,10 @@ namespace kantan
 			unsigned int getId();
 			std::string getName();
 
+			// Index of the kind (the name) in a table keyed by kinds, resolved once so the lookups need no string.
+			unsigned int getKind() const;
+			void setKind(unsigned int kind);
+
 			// Components.
 			void addComponent(Component* comp);
 			void removeComponent(std::string name);
@@ -35,6 +42,7 @@ namespace kantan
 			// Id.
 			unsigned int m_id;
 			std::string m_name;
+			unsigned int m_kind;
 
 			// Components.
 			std::unordered_map<std::string, Component*> m_components;
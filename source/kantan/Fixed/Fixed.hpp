@@ -0,0 +1,79 @@
+#ifndef KANTAN_FIXED
+#define KANTAN_FIXED
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+
+namespace kantan
+{
+    /**
+        Fixed class.
+        Q16.16 fixed-point number: 16 bits of integer part, 16 bits of fractional part.
+        Every operation is done on integers, so the results are the same on every machine and with every compiler flag.
+        The products and quotients are rounded toward minus infinity and saturate instead of overflowing.
+    **/
+    class Fixed
+    {
+        public:
+            // Number of bits of the fractional part.
+            static const int FractionBits = 16;
+            static const sf::Int32 One = 1 << FractionBits;
+
+            // Ctor, 0.
+            Fixed();
+
+            // Ctor, from an integer.
+            Fixed(int value);
+
+            // Floats must go through fromFloat, they are not truncated silently.
+            Fixed(float) = delete;
+            Fixed(double) = delete;
+
+            // Conversions. A float is rounded to the nearest Q16.16 value.
+            static Fixed fromRaw(sf::Int32 raw);
+            static Fixed fromFloat(float value);
+            float toFloat() const;
+            sf::Int32 getRaw() const;
+
+            // Duration of a time, in seconds, computed from its integer microseconds.
+            static Fixed fromTime(sf::Time time);
+
+            // Extreme values.
+            static Fixed max();
+            static Fixed lowest();
+
+            // Arithmetic.
+            Fixed operator-() const;
+            Fixed& operator+=(Fixed other);
+            Fixed& operator-=(Fixed other);
+            Fixed& operator*=(Fixed other);
+            Fixed& operator/=(Fixed other);
+
+        protected:
+            sf::Int32 m_raw;
+    };
+
+    Fixed operator+(Fixed left, Fixed right);
+    Fixed operator-(Fixed left, Fixed right);
+    Fixed operator*(Fixed left, Fixed right);
+    Fixed operator/(Fixed left, Fixed right);
+
+    bool operator==(Fixed left, Fixed right);
+    bool operator!=(Fixed left, Fixed right);
+    bool operator<(Fixed left, Fixed right);
+    bool operator<=(Fixed left, Fixed right);
+    bool operator>(Fixed left, Fixed right);
+    bool operator>=(Fixed left, Fixed right);
+
+    // Include inline definitions.
+    #include "Fixed.inl"
+
+    /*
+        Useful typedef.
+    */
+    typedef sf::Vector2<Fixed> FixedVector2;
+    typedef sf::Rect<Fixed> FixedRect;
+} // namespace kantan.
+
+#endif // KANTAN_FIXED
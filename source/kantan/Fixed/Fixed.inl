@@ -0,0 +1,167 @@
+
+namespace detail
+{
+    // Clamps a 64 bits intermediate result to the Q16.16 range.
+    inline sf::Int32 saturate(std::int64_t value)
+    {
+        if(value > INT32_MAX)
+            return INT32_MAX;
+        if(value < INT32_MIN)
+            return INT32_MIN;
+
+        return static_cast<sf::Int32>(value);
+    }
+
+    // Division rounded toward minus infinity (the built-in one rounds toward 0).
+    inline std::int64_t floorDivide(std::int64_t numerator, std::int64_t denominator)
+    {
+        std::int64_t quotient = numerator / denominator;
+
+        if((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0)))
+            --quotient;
+
+        return quotient;
+    }
+}
+
+inline Fixed::Fixed()
+    : m_raw(0)
+{}
+
+inline Fixed::Fixed(int value)
+    : m_raw(detail::saturate(static_cast<std::int64_t>(value) * One))
+{}
+
+inline Fixed Fixed::fromRaw(sf::Int32 raw)
+{
+    Fixed result;
+    result.m_raw = raw;
+    return result;
+}
+
+inline Fixed Fixed::fromFloat(float value)
+{
+    // Scaling by a power of 2 is exact, only the rounding to an integer loses precision.
+    double scaled = static_cast<double>(value) * One;
+
+    if(!(scaled == scaled))
+        return Fixed();
+
+    scaled += scaled < 0.0 ? -0.5 : 0.5;
+
+    if(scaled >= static_cast<double>(INT32_MAX))
+        return max();
+    if(scaled <= static_cast<double>(INT32_MIN))
+        return lowest();
+
+    return fromRaw(static_cast<sf::Int32>(scaled));
+}
+
+inline float Fixed::toFloat() const
+{
+    return static_cast<float>(m_raw) / One;
+}
+
+inline sf::Int32 Fixed::getRaw() const
+{
+    return m_raw;
+}
+
+inline Fixed Fixed::fromTime(sf::Time time)
+{
+    return fromRaw(detail::saturate(detail::floorDivide(time.asMicroseconds() * One, 1000000)));
+}
+
+inline Fixed Fixed::max()
+{
+    return fromRaw(INT32_MAX);
+}
+
+inline Fixed Fixed::lowest()
+{
+    return fromRaw(INT32_MIN);
+}
+
+inline Fixed Fixed::operator-() const
+{
+    return fromRaw(detail::saturate(-static_cast<std::int64_t>(m_raw)));
+}
+
+inline Fixed& Fixed::operator+=(Fixed other)
+{
+    m_raw = detail::saturate(static_cast<std::int64_t>(m_raw) + other.m_raw);
+    return *this;
+}
+
+inline Fixed& Fixed::operator-=(Fixed other)
+{
+    m_raw = detail::saturate(static_cast<std::int64_t>(m_raw) - other.m_raw);
+    return *this;
+}
+
+inline Fixed& Fixed::operator*=(Fixed other)
+{
+    m_raw = detail::saturate(detail::floorDivide(static_cast<std::int64_t>(m_raw) * other.m_raw, One));
+    return *this;
+}
+
+inline Fixed& Fixed::operator/=(Fixed other)
+{
+    // Dividing by 0 gives the extreme value of the sign of the numerator.
+    if(other.m_raw == 0)
+        m_raw = m_raw < 0 ? INT32_MIN : INT32_MAX;
+    else
+        m_raw = detail::saturate(detail::floorDivide(static_cast<std::int64_t>(m_raw) * One, other.m_raw));
+
+    return *this;
+}
+
+inline Fixed operator+(Fixed left, Fixed right)
+{
+    return left += right;
+}
+
+inline Fixed operator-(Fixed left, Fixed right)
+{
+    return left -= right;
+}
+
+inline Fixed operator*(Fixed left, Fixed right)
+{
+    return left *= right;
+}
+
+inline Fixed operator/(Fixed left, Fixed right)
+{
+    return left /= right;
+}
+
+inline bool operator==(Fixed left, Fixed right)
+{
+    return left.getRaw() == right.getRaw();
+}
+
+inline bool operator!=(Fixed left, Fixed right)
+{
+    return left.getRaw() != right.getRaw();
+}
+
+inline bool operator<(Fixed left, Fixed right)
+{
+    return left.getRaw() < right.getRaw();
+}
+
+inline bool operator<=(Fixed left, Fixed right)
+{
+    return left.getRaw() <= right.getRaw();
+}
+
+inline bool operator>(Fixed left, Fixed right)
+{
+    return left.getRaw() > right.getRaw();
+}
+
+inline bool operator>=(Fixed left, Fixed right)
+{
+    return left.getRaw() >= right.getRaw();
+}
@@ -0,0 +1,67 @@
+#include "FixedTimestep.hpp"
+
+namespace kantan
+{
+    /// Ctor.
+    FixedTimestep::FixedTimestep(unsigned int tickRate, unsigned int maxSteps)
+        : m_maxSteps(maxSteps)
+        , m_accumulator(sf::Time::Zero)
+        , m_dropped(sf::Time::Zero)
+    {
+        setTickRate(tickRate);
+    }
+
+    /// Tick rate.
+    void FixedTimestep::setTickRate(unsigned int tickRate)
+    {
+        // Microseconds so the accumulator stays exact.
+        m_step = sf::microseconds(1000000 / (tickRate > 0 ? tickRate : 1));
+    }
+
+    sf::Time FixedTimestep::getStep() const
+    {
+        return m_step;
+    }
+
+    /// Max steps.
+    void FixedTimestep::setMaxSteps(unsigned int maxSteps)
+    {
+        m_maxSteps = maxSteps;
+    }
+
+    unsigned int FixedTimestep::getMaxSteps() const
+    {
+        return m_maxSteps;
+    }
+
+    /// Accumulation.
+    unsigned int FixedTimestep::advance(sf::Time frameTime)
+    {
+        if(frameTime > sf::Time::Zero)
+            m_accumulator += frameTime;
+
+        sf::Int64 steps = m_accumulator.asMicroseconds() / m_step.asMicroseconds();
+        m_accumulator -= m_step * steps;
+
+        // Spiral of death protection: drop what we cannot catch up.
+        if(steps > m_maxSteps)
+        {
+            m_dropped += m_step * (steps - static_cast<sf::Int64>(m_maxSteps));
+            steps = m_maxSteps;
+        }
+
+        return static_cast<unsigned int>(steps);
+    }
+
+    /// Interpolation.
+    float FixedTimestep::getAlpha() const
+    {
+        return static_cast<float>(m_accumulator.asMicroseconds()) / static_cast<float>(m_step.asMicroseconds());
+    }
+
+    /// Dropped time.
+    sf::Time FixedTimestep::getDroppedTime() const
+    {
+        return m_dropped;
+    }
+} // namespace kantan.
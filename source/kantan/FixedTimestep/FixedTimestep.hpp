@@ -0,0 +1,49 @@
+#ifndef KANTAN_FIXED_TIMESTEP
+#define KANTAN_FIXED_TIMESTEP
+
+#include <SFML/System.hpp>
+
+namespace kantan
+{
+    /**
+        FixedTimestep class.
+        Accumulates the frame times and tells how many fixed steps of simulation to run for each frame.
+        The number of steps per frame is capped: the time over the cap is dropped instead of being caught up later,
+        so a slow frame cannot make the next ones slower and slower.
+    **/
+    class FixedTimestep
+    {
+        public:
+            // Ctor.
+            FixedTimestep(unsigned int tickRate = 60, unsigned int maxSteps = 5);
+
+            // Tick rate, in steps per second.
+            void setTickRate(unsigned int tickRate);
+            sf::Time getStep() const;
+
+            // Max number of steps run for one frame.
+            void setMaxSteps(unsigned int maxSteps);
+            unsigned int getMaxSteps() const;
+
+            // Adds the frame time and returns the number of steps to run.
+            unsigned int advance(sf::Time frameTime);
+
+            // Interpolation factor between the last two steps, in [0, 1[.
+            float getAlpha() const;
+
+            // Total time dropped by the cap.
+            sf::Time getDroppedTime() const;
+
+        protected:
+            sf::Time m_step;
+            unsigned int m_maxSteps;
+
+            // Time not simulated yet.
+            sf::Time m_accumulator;
+
+            // Time dropped by the cap.
+            sf::Time m_dropped;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_FIXED_TIMESTEP
@@ -0,0 +1,70 @@
+#include "GlyphCache.hpp"
+
+namespace kantan
+{
+    /// Declarations.
+    void GlyphCache::addFont(const std::string& name, const sf::Font& font)
+    {
+        m_fonts[name] = &font;
+    }
+
+    void GlyphCache::declare(const std::string& font, unsigned int characterSize, const sf::String& characters, bool bold, float outlineThickness)
+    {
+        Declaration* declaration = nullptr;
+        for(Declaration& other : m_declarations)
+        {
+            if(other.font == font && other.characterSize == characterSize && other.bold == bold && other.outlineThickness == outlineThickness)
+                declaration = &other;
+        }
+
+        if(!declaration)
+        {
+            m_declarations.push_back(Declaration{font, characterSize, bold, outlineThickness, std::basic_string<sf::Uint32>()});
+            declaration = &m_declarations.back();
+        }
+
+        // Each character once.
+        for(std::size_t i(0) ; i < characters.getSize() ; ++i)
+        {
+            if(declaration->characters.find(characters[i]) == std::basic_string<sf::Uint32>::npos)
+                declaration->characters.push_back(characters[i]);
+        }
+    }
+
+    /// Bake.
+    std::size_t GlyphCache::bake()
+    {
+        std::size_t count = 0;
+
+        for(const Declaration& declaration : m_declarations)
+        {
+            auto found = m_fonts.find(declaration.font);
+            if(found == m_fonts.end())
+                continue;
+
+            const sf::Font& font = *found->second;
+            std::basic_string<sf::Uint32> characters = declaration.characters + static_cast<sf::Uint32>(' ') + static_cast<sf::Uint32>('x');
+
+            // A text with an outline draws the filled glyph over the outlined one.
+            for(sf::Uint32 character : characters)
+            {
+                font.getGlyph(character, declaration.characterSize, declaration.bold);
+                ++count;
+
+                if(declaration.outlineThickness != 0.f)
+                {
+                    font.getGlyph(character, declaration.characterSize, declaration.bold, declaration.outlineThickness);
+                    ++count;
+                }
+            }
+        }
+
+        return count;
+    }
+
+    /// Getters.
+    std::size_t GlyphCache::getDeclarationCount() const
+    {
+        return m_declarations.size();
+    }
+} // namespace kantan.
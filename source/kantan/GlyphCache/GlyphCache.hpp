@@ -0,0 +1,51 @@
+#ifndef KANTAN_GLYPH_CACHE
+#define KANTAN_GLYPH_CACHE
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        GlyphCache class.
+        Characters declared for a font at a size, rasterized in the glyph pages of the font at startup
+        so that no text rasterizes a glyph while playing.
+    **/
+    class GlyphCache
+    {
+        public:
+            // Registers a font under a name (its file name for example).
+            void addFont(const std::string& name, const sf::Font& font);
+
+            // Declares characters of a font at a size, with the bold and outline thickness of the texts using them.
+            // Declarations of the same font, size, bold and outline are merged.
+            void declare(const std::string& font, unsigned int characterSize, const sf::String& characters, bool bold = false, float outlineThickness = 0.f);
+
+            // Rasterizes the declared glyphs of the registered fonts, with the space and the 'x' every sf::Text asks for.
+            // Returns the number of glyphs asked for.
+            std::size_t bake();
+
+            // Number of declarations.
+            std::size_t getDeclarationCount() const;
+
+        protected:
+            // Declaration.
+            struct Declaration
+            {
+                std::string font;
+                unsigned int characterSize;
+                bool bold;
+                float outlineThickness;
+                std::basic_string<sf::Uint32> characters;
+            };
+
+            std::map<std::string, const sf::Font*> m_fonts;
+            std::vector<Declaration> m_declarations;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_GLYPH_CACHE
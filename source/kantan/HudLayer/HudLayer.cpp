@@ -0,0 +1,167 @@
+#include "HudLayer.hpp"
+
+#include <stdexcept>
+
+namespace kantan
+{
+    /// Ctor.
+    HudLayer::HudLayer()
+        : m_changed(true)
+        , m_renderCount(0)
+    {}
+
+    void HudLayer::create(const sf::Vector2u& size)
+    {
+        if(!m_texture.create(size.x, size.y))
+            throw std::runtime_error("HudLayer::create - Failed to create the texture");
+
+        m_changed = true;
+    }
+
+    /// Widgets.
+    std::size_t HudLayer::addText(const sf::Font& font, unsigned int characterSize, const sf::Vector2f& position, const sf::Color& background, float padding)
+    {
+        Widget widget = Widget();
+        widget.type = WidgetType::Text;
+        widget.visible = true;
+        widget.text.setFont(font);
+        widget.text.setCharacterSize(characterSize);
+        widget.text.setPosition(position);
+        widget.background.setPosition(position);
+        widget.background.setFillColor(background);
+        widget.padding = padding;
+
+        m_widgets.push_back(widget);
+        m_changed = true;
+
+        return m_widgets.size() - 1;
+    }
+
+    std::size_t HudLayer::addSprites(const sf::Sprite& sprite, const sf::Vector2f& step, unsigned int count)
+    {
+        Widget widget = Widget();
+        widget.type = WidgetType::Sprites;
+        widget.visible = true;
+        widget.sprite = sprite;
+        widget.step = step;
+        widget.count = count;
+
+        m_widgets.push_back(widget);
+        m_changed = true;
+
+        return m_widgets.size() - 1;
+    }
+
+    void HudLayer::setString(std::size_t widget, const sf::String& string)
+    {
+        Widget& text = m_widgets[widget];
+        if(text.text.getString() == string)
+            return;
+
+        text.text.setString(string);
+        layout(text);
+        m_changed = true;
+    }
+
+    void HudLayer::setTextStyle(std::size_t widget, unsigned int characterSize, const sf::Color& color)
+    {
+        Widget& text = m_widgets[widget];
+        if(text.text.getCharacterSize() == characterSize && text.text.getFillColor() == color)
+            return;
+
+        text.text.setCharacterSize(characterSize);
+        text.text.setFillColor(color);
+        layout(text);
+        m_changed = true;
+    }
+
+    void HudLayer::setCount(std::size_t widget, unsigned int count)
+    {
+        if(m_widgets[widget].count == count)
+            return;
+
+        m_widgets[widget].count = count;
+        m_changed = true;
+    }
+
+    void HudLayer::setTextureRect(std::size_t widget, const sf::IntRect& rect)
+    {
+        if(m_widgets[widget].sprite.getTextureRect() == rect)
+            return;
+
+        m_widgets[widget].sprite.setTextureRect(rect);
+        m_changed = true;
+    }
+
+    void HudLayer::setVisible(std::size_t widget, bool visible)
+    {
+        if(m_widgets[widget].visible == visible)
+            return;
+
+        m_widgets[widget].visible = visible;
+        m_changed = true;
+    }
+
+    void HudLayer::layout(Widget& widget)
+    {
+        // Only a background that is drawn needs the bounds of the text.
+        if(widget.background.getFillColor().a == 0)
+            return;
+
+        sf::FloatRect bounds = widget.text.getGlobalBounds();
+        widget.background.setSize(sf::Vector2f(bounds.width + widget.padding, bounds.height + widget.padding));
+    }
+
+    /// Render.
+    bool HudLayer::update()
+    {
+        if(!m_changed)
+            return false;
+
+        m_texture.clear(sf::Color::Transparent);
+
+        for(const Widget& widget : m_widgets)
+        {
+            if(!widget.visible)
+                continue;
+
+            if(widget.type == WidgetType::Text)
+            {
+                if(widget.background.getFillColor().a != 0)
+                    m_texture.draw(widget.background);
+
+                m_texture.draw(widget.text);
+            }
+            else
+            {
+                sf::RenderStates states;
+                for(unsigned int i(0) ; i < widget.count ; ++i)
+                {
+                    m_texture.draw(widget.sprite, states);
+                    states.transform.translate(widget.step);
+                }
+            }
+        }
+
+        m_texture.display();
+
+        m_changed = false;
+        ++m_renderCount;
+
+        return true;
+    }
+
+    std::size_t HudLayer::getRenderCount() const
+    {
+        return m_renderCount;
+    }
+
+    /// Draw.
+    void HudLayer::draw(sf::RenderTarget& target, sf::RenderStates states) const
+    {
+        // All the widgets in one quad. They were blended over a transparent texture, so its colors are already
+        // multiplied by their alpha: blending them with BlendAlpha again would darken the edges.
+        states.blendMode = sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha);
+        target.draw(sf::Sprite(m_texture.getTexture()), states);
+    }
+} // namespace kantan.
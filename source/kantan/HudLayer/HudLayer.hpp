@@ -0,0 +1,82 @@
+#ifndef KANTAN_HUD_LAYER
+#define KANTAN_HUD_LAYER
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        HudLayer class.
+        Retained widgets (texts on a background, rows of sprites) rendered once in a texture of the window size.
+        The setters only mark the layer as changed when the value differs, and update() renders the widgets
+        again only then: an idle frame costs the draw of the cached texture.
+    **/
+    class HudLayer : public sf::Drawable
+    {
+        public:
+            // Ctor.
+            HudLayer();
+
+            // Creates the cached texture (throws if it cannot be created).
+            void create(const sf::Vector2u& size);
+
+            // Adds a text and returns its widget. The background has the size of the text plus padding, 0 for none.
+            std::size_t addText(const sf::Font& font, unsigned int characterSize, const sf::Vector2f& position,
+                                const sf::Color& background = sf::Color::Transparent, float padding = 0.f);
+
+            // Adds a row of count sprites, each one step after the previous one, and returns its widget.
+            std::size_t addSprites(const sf::Sprite& sprite, const sf::Vector2f& step, unsigned int count = 1);
+
+            // Text widgets.
+            void setString(std::size_t widget, const sf::String& string);
+            void setTextStyle(std::size_t widget, unsigned int characterSize, const sf::Color& color);
+
+            // Sprite widgets.
+            void setCount(std::size_t widget, unsigned int count);
+            void setTextureRect(std::size_t widget, const sf::IntRect& rect);
+
+            // Shows or hides a widget.
+            void setVisible(std::size_t widget, bool visible);
+
+            // Renders the widgets in the cached texture if one of them changed. Returns true if it did.
+            bool update();
+
+            // Number of times the widgets were rendered.
+            std::size_t getRenderCount() const;
+
+        protected:
+            // Widget.
+            enum class WidgetType {Text, Sprites};
+
+            struct Widget
+            {
+                WidgetType type;
+                bool visible;
+
+                sf::Text text;
+                sf::RectangleShape background;
+                float padding;
+
+                sf::Sprite sprite;
+                sf::Vector2f step;
+                unsigned int count;
+            };
+
+            // Fits the background of a text widget to its text.
+            void layout(Widget& widget);
+
+            // Draws the cached texture.
+            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+            std::vector<Widget> m_widgets;
+
+            sf::RenderTexture m_texture;
+            bool m_changed;
+            std::size_t m_renderCount;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_HUD_LAYER
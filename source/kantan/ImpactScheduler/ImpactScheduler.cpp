@@ -0,0 +1,128 @@
+#include "ImpactScheduler.hpp"
+#include "../Entity/Entity.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace kantan
+{
+    /// Order.
+    bool ImpactScheduler::Later::operator()(const ScheduledImpact& left, const ScheduledImpact& right) const
+    {
+        if(left.time != right.time)
+            return left.time > right.time;
+        if(left.projectileId != right.projectileId)
+            return left.projectileId > right.projectileId;
+        return left.targetId > right.targetId;
+    }
+
+    /// Ctor.
+    ImpactScheduler::ImpactScheduler()
+        : m_compactSize(64)
+    {}
+
+    /// Generations.
+    unsigned int ImpactScheduler::getGeneration(unsigned int entityId) const
+    {
+        auto found = m_generations.find(entityId);
+        return found == m_generations.end() ? 0 : found->second;
+    }
+
+    bool ImpactScheduler::isValid(const ScheduledImpact& impact) const
+    {
+        return impact.projectileGeneration == getGeneration(impact.projectileId) && impact.targetGeneration == getGeneration(impact.targetId);
+    }
+
+    void ImpactScheduler::invalidate(unsigned int entityId)
+    {
+        // Without queued impacts there is nothing to drop. Otherwise the generation is kept
+        // until no queued impact refers to the entity (see compact()).
+        if(!m_queue.empty())
+            ++m_generations[entityId];
+    }
+
+    /// Queue.
+    void ImpactScheduler::schedule(sf::Time time, Entity* projectile, Entity* target)
+    {
+        ScheduledImpact impact;
+        impact.time = time;
+        impact.projectile = projectile;
+        impact.target = target;
+        impact.projectileId = projectile->getId();
+        impact.targetId = target->getId();
+        impact.projectileGeneration = getGeneration(impact.projectileId);
+        impact.targetGeneration = getGeneration(impact.targetId);
+
+        m_queue.push(impact);
+
+        if(m_queue.size() > m_compactSize)
+            compact();
+    }
+
+    std::size_t ImpactScheduler::popDue(sf::Time now, std::vector<ScheduledImpact>& due)
+    {
+        const std::size_t before = due.size();
+
+        while(!m_queue.empty() && m_queue.top().time <= now)
+        {
+            if(isValid(m_queue.top()))
+                due.push_back(m_queue.top());
+
+            m_queue.pop();
+        }
+
+        // No impact refers to the generations anymore.
+        if(m_queue.empty())
+            m_generations.clear();
+
+        return due.size() - before;
+    }
+
+    std::size_t ImpactScheduler::getPendingCount() const
+    {
+        return m_queue.size();
+    }
+
+    void ImpactScheduler::clear()
+    {
+        m_queue = std::priority_queue<ScheduledImpact, std::vector<ScheduledImpact>, Later>();
+        m_generations.clear();
+        m_compactSize = 64;
+    }
+
+    void ImpactScheduler::compact()
+    {
+        std::vector<ScheduledImpact> valid;
+        valid.reserve(m_queue.size());
+
+        while(!m_queue.empty())
+        {
+            if(isValid(m_queue.top()))
+                valid.push_back(m_queue.top());
+
+            m_queue.pop();
+        }
+
+        // Forget the generations of the entities no impact refers to anymore (the removed ones mostly).
+        std::unordered_set<unsigned int> referenced;
+        for(const ScheduledImpact& impact : valid)
+        {
+            referenced.insert(impact.projectileId);
+            referenced.insert(impact.targetId);
+        }
+
+        for(auto itr = m_generations.begin() ; itr != m_generations.end() ;)
+        {
+            if(referenced.count(itr->first) == 0)
+                itr = m_generations.erase(itr);
+            else
+                ++itr;
+        }
+
+        m_queue = std::priority_queue<ScheduledImpact, std::vector<ScheduledImpact>, Later>(Later(), std::move(valid));
+
+        // Next time once the queue doubled, so the cost is amortized.
+        m_compactSize = std::max<std::size_t>(64, 2 * m_queue.size());
+    }
+} // namespace kantan.
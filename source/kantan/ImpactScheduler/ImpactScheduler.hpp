@@ -0,0 +1,78 @@
+#ifndef KANTAN_IMPACT_SCHEDULER
+#define KANTAN_IMPACT_SCHEDULER
+
+#include <SFML/System.hpp>
+
+#include <cstddef>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    class Entity;
+
+    /**
+        ScheduledImpact struct.
+        When a projectile will hit a target, and the generations of both when it was computed.
+    **/
+    struct ScheduledImpact
+    {
+        sf::Time time;
+        Entity* projectile;
+        Entity* target;
+        unsigned int projectileId, targetId;
+        unsigned int projectileGeneration, targetGeneration;
+    };
+
+    /**
+        ImpactScheduler class.
+        Priority queue of the impacts computed ahead of time, for bodies whose motion is known.
+        Invalidating an entity drops every impact involving it (lazily: they are skipped when they come out of the queue),
+        so only the impacts of the entities that changed have to be computed again.
+        Impacts due at the same time come out by projectile then target ids, so the order is the same on every run.
+    **/
+    class ImpactScheduler
+    {
+        public:
+            // Ctor.
+            ImpactScheduler();
+
+            // Schedules an impact.
+            void schedule(sf::Time time, Entity* projectile, Entity* target);
+
+            // Drops the impacts involving the entity (it moved, changed or was removed).
+            void invalidate(unsigned int entityId);
+
+            // Pops the valid impacts due by the given time and appends them to due, in time order.
+            std::size_t popDue(sf::Time now, std::vector<ScheduledImpact>& due);
+
+            // Number of impacts in the queue, including the invalidated ones not popped yet.
+            std::size_t getPendingCount() const;
+
+            // Forgets everything.
+            void clear();
+
+        protected:
+            // Puts the earliest impact on top of the queue.
+            struct Later
+            {
+                bool operator()(const ScheduledImpact& left, const ScheduledImpact& right) const;
+            };
+
+            // Current generation of an entity.
+            unsigned int getGeneration(unsigned int entityId) const;
+
+            // Returns true if nothing changed since the impact was computed.
+            bool isValid(const ScheduledImpact& impact) const;
+
+            // Removes the invalidated impacts once they outnumber the others.
+            void compact();
+
+            std::priority_queue<ScheduledImpact, std::vector<ScheduledImpact>, Later> m_queue;
+            std::unordered_map<unsigned int, unsigned int> m_generations;
+            std::size_t m_compactSize;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_IMPACT_SCHEDULER
@@ -0,0 +1,75 @@
+#include "MortonOrder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kantan
+{
+    namespace
+    {
+        // Spreads the 16 bits of the value on the even bits.
+        std::uint32_t spread(std::uint32_t value)
+        {
+            value = (value | (value << 8)) & 0x00FF00FFu;
+            value = (value | (value << 4)) & 0x0F0F0F0Fu;
+            value = (value | (value << 2)) & 0x33333333u;
+            value = (value | (value << 1)) & 0x55555555u;
+
+            return value;
+        }
+
+        // Cell of a coordinate, on 16 bits.
+        std::uint16_t quantize(float coordinate, float cellSize)
+        {
+            float cell = std::floor(coordinate / cellSize);
+            return static_cast<std::uint16_t>(std::max(0.f, std::min(65535.f, cell)));
+        }
+    }
+
+    /// Codes.
+    std::uint32_t getMortonCode(std::uint16_t x, std::uint16_t y)
+    {
+        return spread(x) | (spread(y) << 1);
+    }
+
+    /// Ctor.
+    MortonOrder::MortonOrder(float cellSize, std::size_t budget)
+        : m_cellSize(cellSize)
+        , m_budget(budget)
+        , m_cursor(0)
+        , m_position(0)
+    {}
+
+    /// Settings.
+    void MortonOrder::setCellSize(float cellSize)
+    {
+        m_cellSize = cellSize;
+        reset();
+    }
+
+    float MortonOrder::getCellSize() const
+    {
+        return m_cellSize;
+    }
+
+    void MortonOrder::setBudget(std::size_t budget)
+    {
+        m_budget = budget;
+    }
+
+    std::size_t MortonOrder::getBudget() const
+    {
+        return m_budget;
+    }
+
+    std::uint32_t MortonOrder::getCode(const sf::Vector2f& position) const
+    {
+        return getMortonCode(quantize(position.x, m_cellSize), quantize(position.y, m_cellSize));
+    }
+
+    void MortonOrder::reset()
+    {
+        m_codes.clear();
+        m_cursor = m_position = 0;
+    }
+} // namespace kantan.
@@ -0,0 +1,65 @@
+#ifndef KANTAN_MORTON_ORDER
+#define KANTAN_MORTON_ORDER
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kantan
+{
+    // Interleaves the bits of two coordinates (x on the even bits, y on the odd ones).
+    std::uint32_t getMortonCode(std::uint16_t x, std::uint16_t y);
+
+    /**
+        MortonOrder class.
+        Sorts a vector of pointers by the Z-order (Morton) code of a position, so items close in space end up close in memory.
+        The sort is an insertion sort run a bit at a time: each call moves at most a budget of items and resumes
+        where the previous one stopped. The codes are taken at the start of each pass, a new pass starts once the
+        vector is sorted or when its content changed.
+    **/
+    class MortonOrder
+    {
+        public:
+            // Code of the items without a position, sorted last.
+            static const std::uint32_t NoCode = 0xFFFFFFFFu;
+
+            // Ctor.
+            MortonOrder(float cellSize = 32.f, std::size_t budget = 256);
+
+            // Size of the cells positions are quantized to.
+            void setCellSize(float cellSize);
+            float getCellSize() const;
+
+            // Max number of moves per call.
+            void setBudget(std::size_t budget);
+            std::size_t getBudget() const;
+
+            // Code of a position (the coordinates are clamped to 16 bits of cells from the origin).
+            std::uint32_t getCode(const sf::Vector2f& position) const;
+
+            // Runs part of the current pass over the items. key returns the code of an item.
+            // Returns true if the items are sorted by the codes of this pass.
+            template<typename T, typename Key>
+            bool refine(std::vector<T*>& items, Key key);
+
+            // Starts a new pass on the next call.
+            void reset();
+
+        protected:
+            float m_cellSize;
+            std::size_t m_budget;
+
+            // Items of the pass with their codes, in the order they are in the vector, the size of the sorted prefix
+            // and where the item being inserted in it is.
+            std::vector<std::pair<std::uint32_t, const void*>> m_codes;
+            std::size_t m_cursor, m_position;
+    };
+
+    // Include template definition.
+    #include "MortonOrder.inl"
+} // namespace kantan.
+
+#endif // KANTAN_MORTON_ORDER
@@ -0,0 +1,43 @@
+
+template<typename T, typename Key>
+bool MortonOrder::refine(std::vector<T*>& items, Key key)
+{
+    // The vector changed since the last call (or the pass is over): start a new pass.
+    bool changed = m_codes.size() != items.size();
+
+    for(std::size_t i(0) ; !changed && i < items.size() ; ++i)
+        changed = m_codes[i].second != static_cast<const void*>(items[i]);
+
+    if(changed || m_cursor >= items.size())
+    {
+        m_codes.resize(items.size());
+
+        for(std::size_t i(0) ; i < items.size() ; ++i)
+            m_codes[i] = std::make_pair(key(items[i]), static_cast<const void*>(items[i]));
+
+        m_cursor = m_position = std::min<std::size_t>(1, items.size());
+    }
+
+    // Insert the next items in the sorted prefix, until the budget is spent.
+    std::size_t moves = 0;
+
+    while(m_cursor < items.size() && moves < m_budget)
+    {
+        while(m_position > 0 && m_codes[m_position - 1].first > m_codes[m_position].first && moves < m_budget)
+        {
+            std::swap(m_codes[m_position - 1], m_codes[m_position]);
+            std::swap(items[m_position - 1], items[m_position]);
+
+            --m_position;
+            ++moves;
+        }
+
+        // Out of budget in the middle of an insertion, it goes on next call.
+        if(m_position > 0 && m_codes[m_position - 1].first > m_codes[m_position].first)
+            break;
+
+        m_position = ++m_cursor;
+    }
+
+    return m_cursor >= items.size();
+}
@@ -0,0 +1,76 @@
+#include "ParticleBudget.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kantan
+{
+    /// Ctor.
+    ParticleBudget::ParticleBudget(sf::Time frameBudget, float minScale)
+        : m_frameBudget(frameBudget)
+        , m_minScale(minScale)
+        , m_averageFrame(-1.f)
+        , m_scale(1.f)
+    {}
+
+    /// Settings.
+    void ParticleBudget::setFrameBudget(sf::Time frameBudget)
+    {
+        m_frameBudget = frameBudget;
+    }
+
+    sf::Time ParticleBudget::getFrameBudget() const
+    {
+        return m_frameBudget;
+    }
+
+    void ParticleBudget::setMinScale(float minScale)
+    {
+        m_minScale = std::min(std::max(minScale, 0.f), 1.f);
+        m_scale = std::max(m_scale, m_minScale);
+    }
+
+    float ParticleBudget::getMinScale() const
+    {
+        return m_minScale;
+    }
+
+    /// Frames.
+    void ParticleBudget::recordFrame(sf::Time frame)
+    {
+        const float budget = m_frameBudget.asSeconds();
+
+        // A few frames of memory, so one hitch does not cut the particles.
+        if(m_averageFrame < 0.f)
+            m_averageFrame = frame.asSeconds();
+        else
+            m_averageFrame += (frame.asSeconds() - m_averageFrame) * 0.1f;
+
+        // Over budget: scale down, faster the more it is over. Well under: come back slowly.
+        if(m_averageFrame > budget)
+            m_scale = std::max(m_minScale, m_scale - 0.05f * std::min(1.f, m_averageFrame / budget - 1.f));
+        else if(m_averageFrame < budget * 0.8f)
+            m_scale = std::min(1.f, m_scale + 0.01f);
+    }
+
+    float ParticleBudget::getScale() const
+    {
+        return m_scale;
+    }
+
+    sf::Time ParticleBudget::getAverageFrame() const
+    {
+        return sf::seconds(std::max(m_averageFrame, 0.f));
+    }
+
+    /// Count.
+    std::size_t ParticleBudget::getCount(std::size_t requested, std::size_t live, std::size_t budget) const
+    {
+        // Past half of the budget, the emitters shrink as it fills.
+        float fill = budget != 0 ? static_cast<float>(live) / static_cast<float>(budget) : 1.f;
+        float occupancy = fill < 0.5f ? 1.f : std::max(m_minScale, 2.f * (1.f - fill));
+
+        float scale = std::max(m_minScale, m_scale * occupancy);
+        return static_cast<std::size_t>(std::ceil(static_cast<float>(requested) * scale));
+    }
+} // namespace kantan.
@@ -0,0 +1,51 @@
+#ifndef KANTAN_PARTICLE_BUDGET
+#define KANTAN_PARTICLE_BUDGET
+
+#include <SFML/System.hpp>
+
+#include <cstddef>
+
+namespace kantan
+{
+    /**
+        ParticleBudget class.
+        Level of detail of the particle emitters: the number of particles a new emitter gets goes down
+        when the frames take longer than the frame budget, and when the live particles get close to the particle budget.
+    **/
+    class ParticleBudget
+    {
+        public:
+            // Ctor.
+            explicit ParticleBudget(sf::Time frameBudget = sf::seconds(1.f / 60.f), float minScale = 0.1f);
+
+            // Time a frame should take at most.
+            void setFrameBudget(sf::Time frameBudget);
+            sf::Time getFrameBudget() const;
+
+            // Smallest part of the requested particles an emitter gets.
+            void setMinScale(float minScale);
+            float getMinScale() const;
+
+            // Records the time the last frame took to update and render, without the wait for the display.
+            void recordFrame(sf::Time frame);
+
+            // Part of the requested particles the frame times allow, in [min scale, 1].
+            float getScale() const;
+
+            // Average duration of the last frames.
+            sf::Time getAverageFrame() const;
+
+            // Number of particles for an emitter asking for requested ones, given the live particles and the particle budget.
+            std::size_t getCount(std::size_t requested, std::size_t live, std::size_t budget) const;
+
+        protected:
+            sf::Time m_frameBudget;
+            float m_minScale;
+
+            // Exponential average of the frame durations, in seconds (negative before the first frame).
+            float m_averageFrame;
+            float m_scale;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_PARTICLE_BUDGET
@@ -0,0 +1,575 @@
+#include "ParticleEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define KANTAN_PARTICLE_X86
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #define KANTAN_PARTICLE_TARGET(isa)
+    #else
+        #define KANTAN_PARTICLE_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+namespace kantan
+{
+    namespace
+    {
+        // Arrays the kernels work on.
+        struct ParticleArrays
+        {
+            float* px;
+            float* py;
+            float* vx;
+            float* vy;
+            float* life;
+            sf::Uint32* colors;
+            sf::Vertex* vertices;
+        };
+
+        // Burst the spawn kernels fill, with the bounds as offset and scale of the random bits.
+        struct SpawnSettings
+        {
+            float x, y;
+            sf::Uint32 color;
+            float minSpeed, speedScale;
+            float minLifetime, lifetimeScale;
+            sf::Uint32 counter, key;
+        };
+
+        // Unit directions, indexed by the low bits of the random numbers.
+        const std::size_t DirectionBits = 10;
+        const sf::Uint32 DirectionMask = (1u << DirectionBits) - 1;
+
+        struct DirectionTable
+        {
+            DirectionTable()
+            {
+                for(std::size_t i(0) ; i <= DirectionMask ; ++i)
+                {
+                    double angle = 2.0 * 3.14159265358979323846 * i / (DirectionMask + 1);
+                    cosines[i] = static_cast<float>(std::cos(angle));
+                    sines[i] = static_cast<float>(std::sin(angle));
+                }
+            }
+
+            float cosines[DirectionMask + 1];
+            float sines[DirectionMask + 1];
+        };
+
+        const DirectionTable& getDirections()
+        {
+            static const DirectionTable table;
+            return table;
+        }
+
+        // Counter-based generator: the number of a particle only depends on its counter and the key,
+        // so a whole burst is computed at once. The 32 bits give the direction (10), the speed (11) and the lifetime (11).
+        inline sf::Uint32 random(sf::Uint32 counter, sf::Uint32 key)
+        {
+            sf::Uint32 x = counter * 0x9E3779B9u + key;
+            x ^= x >> 16;
+            x *= 0x7FEB352Du;
+            x ^= x >> 15;
+            x *= 0x846CA68Bu;
+            x ^= x >> 16;
+            return x;
+        }
+
+        // Packs the color without its alpha, like sf::Color in memory.
+        inline sf::Uint32 packColor(const sf::Color& color)
+        {
+            sf::Uint8 bytes[4] = {color.r, color.g, color.b, 0};
+            sf::Uint32 packed;
+            std::memcpy(&packed, bytes, sizeof(packed));
+            return packed;
+        }
+
+        // Alpha of a particle with the given remaining lifetime, in [0, 255].
+        inline sf::Uint32 fade(float life)
+        {
+            return static_cast<sf::Uint32>(std::min(std::max(life, 0.f), 1.f) * 255.f);
+        }
+
+        // Writes a vertex, the color packed with its alpha.
+        inline void writeVertex(sf::Vertex& vertex, float x, float y, sf::Uint32 color, sf::Uint32 alpha)
+        {
+            sf::Uint8 bytes[4];
+            std::memcpy(bytes, &color, sizeof(bytes));
+
+            vertex.position.x = x;
+            vertex.position.y = y;
+            vertex.color = sf::Color(bytes[0], bytes[1], bytes[2], static_cast<sf::Uint8>(alpha));
+        }
+
+        // Plain loop, also used for the tail of the vectorized versions.
+        void updateScalar(const ParticleArrays& p, std::size_t begin, std::size_t end, float dt)
+        {
+            for(std::size_t i(begin) ; i < end ; ++i)
+            {
+                p.life[i] -= dt;
+                p.px[i] += p.vx[i] * dt;
+                p.py[i] += p.vy[i] * dt;
+
+                writeVertex(p.vertices[i], p.px[i], p.py[i], p.colors[i], fade(p.life[i]));
+            }
+        }
+
+        // Plain spawn, also used for the tail of the vectorized version.
+        void spawnScalar(const ParticleArrays& p, std::size_t begin, std::size_t end, const SpawnSettings& burst)
+        {
+            const DirectionTable& directions = getDirections();
+
+            for(std::size_t i(begin) ; i < end ; ++i)
+            {
+                sf::Uint32 bits = random(burst.counter + static_cast<sf::Uint32>(i), burst.key);
+                sf::Uint32 direction = bits & DirectionMask;
+                float speed = burst.minSpeed + static_cast<float>(static_cast<int>((bits >> 10) & 0x7FF)) * burst.speedScale;
+                float life = burst.minLifetime + static_cast<float>(static_cast<int>(bits >> 21)) * burst.lifetimeScale;
+
+                p.px[i] = burst.x;
+                p.py[i] = burst.y;
+                p.vx[i] = directions.cosines[direction] * speed;
+                p.vy[i] = directions.sines[direction] * speed;
+                p.life[i] = life;
+                p.colors[i] = burst.color;
+
+                writeVertex(p.vertices[i], burst.x, burst.y, burst.color, fade(life));
+            }
+        }
+
+        #ifdef KANTAN_PARTICLE_X86
+        // The vector versions build the color word directly, so the alpha is the high byte (little endian).
+        KANTAN_PARTICLE_TARGET("sse2")
+        void updateSSE(const ParticleArrays& p, std::size_t n, float dt)
+        {
+            const __m128 step = _mm_set1_ps(dt), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f), scale = _mm_set1_ps(255.f);
+            const __m128i rgb = _mm_set1_epi32(0x00FFFFFF);
+
+            alignas(16) float x[4], y[4];
+            alignas(16) sf::Uint32 colors[4];
+
+            std::size_t i(0);
+            for( ; i + 4 <= n ; i += 4)
+            {
+                __m128 life = _mm_sub_ps(_mm_loadu_ps(&p.life[i]), step);
+                __m128 px = _mm_add_ps(_mm_loadu_ps(&p.px[i]), _mm_mul_ps(_mm_loadu_ps(&p.vx[i]), step));
+                __m128 py = _mm_add_ps(_mm_loadu_ps(&p.py[i]), _mm_mul_ps(_mm_loadu_ps(&p.vy[i]), step));
+
+                _mm_storeu_ps(&p.life[i], life);
+                _mm_storeu_ps(&p.px[i], px);
+                _mm_storeu_ps(&p.py[i], py);
+
+                __m128i alpha = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(life, zero), one), scale));
+                __m128i color = _mm_or_si128(_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&p.colors[i])), rgb), _mm_slli_epi32(alpha, 24));
+
+                _mm_store_ps(x, px);
+                _mm_store_ps(y, py);
+                _mm_store_si128(reinterpret_cast<__m128i*>(colors), color);
+
+                for(std::size_t k(0) ; k < 4 ; ++k)
+                    writeVertex(p.vertices[i + k], x[k], y[k], colors[k], colors[k] >> 24);
+            }
+
+            updateScalar(p, i, n, dt);
+        }
+
+        KANTAN_PARTICLE_TARGET("avx2")
+        void updateAVX2(const ParticleArrays& p, std::size_t n, float dt)
+        {
+            const __m256 step = _mm256_set1_ps(dt), zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.f), scale = _mm256_set1_ps(255.f);
+            const __m256i rgb = _mm256_set1_epi32(0x00FFFFFF);
+
+            alignas(32) float x[8], y[8];
+            alignas(32) sf::Uint32 colors[8];
+
+            std::size_t i(0);
+            for( ; i + 8 <= n ; i += 8)
+            {
+                __m256 life = _mm256_sub_ps(_mm256_loadu_ps(&p.life[i]), step);
+                __m256 px = _mm256_add_ps(_mm256_loadu_ps(&p.px[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.vx[i]), step));
+                __m256 py = _mm256_add_ps(_mm256_loadu_ps(&p.py[i]), _mm256_mul_ps(_mm256_loadu_ps(&p.vy[i]), step));
+
+                _mm256_storeu_ps(&p.life[i], life);
+                _mm256_storeu_ps(&p.px[i], px);
+                _mm256_storeu_ps(&p.py[i], py);
+
+                __m256i alpha = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(life, zero), one), scale));
+                __m256i color = _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&p.colors[i])), rgb), _mm256_slli_epi32(alpha, 24));
+
+                _mm256_store_ps(x, px);
+                _mm256_store_ps(y, py);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(colors), color);
+
+                for(std::size_t k(0) ; k < 8 ; ++k)
+                    writeVertex(p.vertices[i + k], x[k], y[k], colors[k], colors[k] >> 24);
+            }
+
+            updateScalar(p, i, n, dt);
+        }
+
+        // Spawn with the random numbers computed 8 at a time and the directions gathered from the table.
+        KANTAN_PARTICLE_TARGET("avx2")
+        void spawnAVX2(const ParticleArrays& p, std::size_t n, const SpawnSettings& burst)
+        {
+            const DirectionTable& directions = getDirections();
+
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const __m256i golden = _mm256_set1_epi32(static_cast<int>(0x9E3779B9u)), key = _mm256_set1_epi32(static_cast<int>(burst.key));
+            const __m256i first = _mm256_set1_epi32(static_cast<int>(0x7FEB352Du)), second = _mm256_set1_epi32(static_cast<int>(0x846CA68Bu));
+            const __m256i directionMask = _mm256_set1_epi32(static_cast<int>(DirectionMask)), speedMask = _mm256_set1_epi32(0x7FF);
+            const __m256 minSpeed = _mm256_set1_ps(burst.minSpeed), speedScale = _mm256_set1_ps(burst.speedScale);
+            const __m256 minLifetime = _mm256_set1_ps(burst.minLifetime), lifetimeScale = _mm256_set1_ps(burst.lifetimeScale);
+            const __m256 x = _mm256_set1_ps(burst.x), y = _mm256_set1_ps(burst.y);
+            const __m256i color = _mm256_set1_epi32(static_cast<int>(burst.color));
+
+            alignas(32) float lifes[8];
+
+            std::size_t i(0);
+            for( ; i + 8 <= n ; i += 8)
+            {
+                // Same numbers as random(), lane by lane.
+                __m256i counter = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(burst.counter + static_cast<sf::Uint32>(i))), lanes);
+                __m256i bits = _mm256_add_epi32(_mm256_mullo_epi32(counter, golden), key);
+                bits = _mm256_xor_si256(bits, _mm256_srli_epi32(bits, 16));
+                bits = _mm256_mullo_epi32(bits, first);
+                bits = _mm256_xor_si256(bits, _mm256_srli_epi32(bits, 15));
+                bits = _mm256_mullo_epi32(bits, second);
+                bits = _mm256_xor_si256(bits, _mm256_srli_epi32(bits, 16));
+
+                __m256i direction = _mm256_and_si256(bits, directionMask);
+                __m256 speed = _mm256_add_ps(minSpeed, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(bits, 10), speedMask)), speedScale));
+                __m256 life = _mm256_add_ps(minLifetime, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 21)), lifetimeScale));
+
+                _mm256_storeu_ps(&p.px[i], x);
+                _mm256_storeu_ps(&p.py[i], y);
+                _mm256_storeu_ps(&p.vx[i], _mm256_mul_ps(_mm256_i32gather_ps(directions.cosines, direction, 4), speed));
+                _mm256_storeu_ps(&p.vy[i], _mm256_mul_ps(_mm256_i32gather_ps(directions.sines, direction, 4), speed));
+                _mm256_storeu_ps(&p.life[i], life);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(&p.colors[i]), color);
+
+                _mm256_store_ps(lifes, life);
+
+                for(std::size_t k(0) ; k < 8 ; ++k)
+                    writeVertex(p.vertices[i + k], burst.x, burst.y, burst.color, fade(lifes[k]));
+            }
+
+            spawnScalar(p, i, n, burst);
+        }
+        #endif // KANTAN_PARTICLE_X86
+    }
+
+    /// Ctor.
+    ParticleEngine::ParticleEngine(std::size_t capacity)
+        : m_level(detectSimdLevel())
+        , m_seed(0)
+        , m_counter(0)
+        , m_budget(capacity)
+        , m_threads(nullptr)
+    {
+        setCapacity(capacity);
+    }
+
+    ParticleEngine::ParticleEngine(std::size_t capacity, SimdLevel level)
+        : m_level(isSimdLevelSupported(level) ? level : SimdLevel::Scalar)
+        , m_seed(0)
+        , m_counter(0)
+        , m_budget(capacity)
+        , m_threads(nullptr)
+    {
+        setCapacity(capacity);
+    }
+
+    /// Level.
+    SimdLevel ParticleEngine::getLevel() const
+    {
+        return m_level;
+    }
+
+    /// Capacity.
+    void ParticleEngine::setCapacity(std::size_t capacity)
+    {
+        m_capacity = capacity;
+        m_budget = std::min(m_budget, capacity);
+
+        m_px.assign(capacity, 0.f);
+        m_py.assign(capacity, 0.f);
+        m_vx.assign(capacity, 0.f);
+        m_vy.assign(capacity, 0.f);
+        m_life.assign(capacity, 0.f);
+        m_colors.assign(capacity, 0);
+        m_vertices.assign(capacity, sf::Vertex());
+
+        clear();
+    }
+
+    std::size_t ParticleEngine::getCapacity() const
+    {
+        return m_capacity;
+    }
+
+    /// Budget.
+    void ParticleEngine::setBudget(std::size_t budget)
+    {
+        m_budget = std::min(budget, m_capacity);
+
+        if(m_live > m_budget)
+            cull(m_live - m_budget, std::numeric_limits<int>::max());
+    }
+
+    std::size_t ParticleEngine::getBudget() const
+    {
+        return m_budget;
+    }
+
+    std::size_t ParticleEngine::getLiveCount() const
+    {
+        return m_live;
+    }
+
+    void ParticleEngine::cull(std::size_t excess, int priority)
+    {
+        std::size_t freed = 0;
+
+        while(freed < excess)
+        {
+            // Lowest priority first, the oldest of them first.
+            Emitter* victim = nullptr;
+            for(Emitter& emitter : m_emitters)
+            {
+                if(emitter.remaining > sf::Time::Zero && emitter.priority <= priority && (!victim || emitter.priority < victim->priority))
+                    victim = &emitter;
+            }
+
+            if(!victim)
+                break;
+
+            kill(*victim);
+            freed += victim->count;
+        }
+    }
+
+    void ParticleEngine::kill(Emitter& emitter)
+    {
+        emitter.remaining = sf::Time::Zero;
+        m_live -= emitter.count;
+
+        // Hidden from the next update on, the range is freed with the head of the ring or the next compaction.
+        std::fill(m_life.begin() + emitter.begin, m_life.begin() + emitter.begin + emitter.count, 0.f);
+    }
+
+    /// Emitters.
+    std::size_t ParticleEngine::addEmitter(std::size_t count, sf::Time lifetime, int priority)
+    {
+        count = std::min(count, m_budget);
+
+        // Over budget: cull the emitters that do not matter more than this one, and shrink it if that is not enough.
+        if(m_live + count > m_budget)
+            cull(m_live + count - m_budget, priority);
+
+        count = std::min(count, m_budget - m_live);
+
+        if(m_tail + count > m_capacity)
+            compact(count);
+
+        Emitter emitter = {m_tail, count, lifetime, priority};
+        m_emitters.push_back(emitter);
+        m_tail += count;
+        m_live += count;
+
+        return emitter.begin;
+    }
+
+    std::size_t ParticleEngine::getLastEmitterSize() const
+    {
+        return m_emitters.empty() ? 0 : m_emitters.back().count;
+    }
+
+    std::size_t ParticleEngine::addBurst(const ParticleBurst& burst)
+    {
+        std::size_t first = addEmitter(burst.count, burst.duration, burst.priority);
+        std::size_t count = getLastEmitterSize();
+
+        // Speeds and lifetimes are spread over 2048 steps between their bounds.
+        SpawnSettings settings;
+        settings.x = burst.center.x;
+        settings.y = burst.center.y;
+        settings.color = packColor(burst.color);
+        settings.minSpeed = burst.minSpeed;
+        settings.speedScale = (burst.maxSpeed - burst.minSpeed) / 2048.f;
+        settings.minLifetime = burst.minLifetime.asSeconds();
+        settings.lifetimeScale = (burst.maxLifetime - burst.minLifetime).asSeconds() / 2048.f;
+        settings.counter = m_counter;
+        settings.key = m_seed;
+
+        m_counter += static_cast<sf::Uint32>(count);
+
+        ParticleArrays arrays = {&m_px[first], &m_py[first], &m_vx[first], &m_vy[first], &m_life[first], &m_colors[first], &m_vertices[first]};
+
+        switch(m_level)
+        {
+            #ifdef KANTAN_PARTICLE_X86
+            case SimdLevel::AVX512:
+            case SimdLevel::AVX2:
+                spawnAVX2(arrays, count, settings);
+                break;
+            #endif
+            default:
+                spawnScalar(arrays, 0, count, settings);
+                break;
+        }
+
+        return first;
+    }
+
+    void ParticleEngine::setSeed(sf::Uint32 seed)
+    {
+        m_seed = seed;
+        m_counter = 0;
+    }
+
+    void ParticleEngine::setParticle(std::size_t index, const sf::Vector2f& position, const sf::Vector2f& velocity, sf::Time lifetime, const sf::Color& color)
+    {
+        sf::Uint32 packed = packColor(color);
+
+        m_px[index] = position.x;
+        m_py[index] = position.y;
+        m_vx[index] = velocity.x;
+        m_vy[index] = velocity.y;
+        m_life[index] = lifetime.asSeconds();
+        m_colors[index] = packed;
+
+        writeVertex(m_vertices[index], position.x, position.y, packed, fade(lifetime.asSeconds()));
+    }
+
+    void ParticleEngine::compact(std::size_t room)
+    {
+        // Drop the expired emitters, and the oldest ones while there is not enough room.
+        std::deque<Emitter> kept;
+        std::size_t to = 0;
+
+        for(const Emitter& emitter : m_emitters)
+        {
+            if(emitter.remaining <= sf::Time::Zero)
+                continue;
+
+            if(m_live + room > m_capacity)
+            {
+                m_live -= emitter.count;
+                continue;
+            }
+
+            // Ranges only move toward the start of the pool.
+            move(emitter.begin, emitter.count, to);
+            kept.push_back(Emitter{to, emitter.count, emitter.remaining, emitter.priority});
+            to += emitter.count;
+        }
+
+        m_emitters.swap(kept);
+        m_head = 0;
+        m_tail = to;
+    }
+
+    void ParticleEngine::move(std::size_t from, std::size_t count, std::size_t to)
+    {
+        if(from == to)
+            return;
+
+        std::copy(m_px.begin() + from, m_px.begin() + from + count, m_px.begin() + to);
+        std::copy(m_py.begin() + from, m_py.begin() + from + count, m_py.begin() + to);
+        std::copy(m_vx.begin() + from, m_vx.begin() + from + count, m_vx.begin() + to);
+        std::copy(m_vy.begin() + from, m_vy.begin() + from + count, m_vy.begin() + to);
+        std::copy(m_life.begin() + from, m_life.begin() + from + count, m_life.begin() + to);
+        std::copy(m_colors.begin() + from, m_colors.begin() + from + count, m_colors.begin() + to);
+        std::copy(m_vertices.begin() + from, m_vertices.begin() + from + count, m_vertices.begin() + to);
+    }
+
+    /// Update.
+    void ParticleEngine::update(sf::Time elapsed)
+    {
+        // Age the emitters, the particles of the ones expiring die with them.
+        for(Emitter& emitter : m_emitters)
+        {
+            if(emitter.remaining <= sf::Time::Zero)
+                continue;
+
+            emitter.remaining -= elapsed;
+
+            if(emitter.remaining <= sf::Time::Zero)
+                kill(emitter);
+        }
+
+        // Free the expired emitters at the head of the ring.
+        while(!m_emitters.empty() && m_emitters.front().remaining <= sf::Time::Zero)
+            m_emitters.pop_front();
+
+        if(m_emitters.empty())
+            m_head = m_tail = 0;
+        else
+            m_head = m_emitters.front().begin;
+
+        // Update the live range, in chunks shared between the threads. Each chunk only touches its own particles and vertices.
+        const std::size_t n = size();
+        const float dt = elapsed.asSeconds();
+
+        auto run = [this, dt](std::size_t begin, std::size_t end, unsigned int)
+        {
+            std::size_t i = m_head + begin;
+            ParticleArrays arrays = {&m_px[i], &m_py[i], &m_vx[i], &m_vy[i], &m_life[i], &m_colors[i], &m_vertices[i]};
+
+            switch(m_level)
+            {
+                #ifdef KANTAN_PARTICLE_X86
+                case SimdLevel::AVX512:
+                case SimdLevel::AVX2:
+                    updateAVX2(arrays, end - begin, dt);
+                    break;
+                case SimdLevel::SSE:
+                    updateSSE(arrays, end - begin, dt);
+                    break;
+                #endif
+                default:
+                    updateScalar(arrays, 0, end - begin, dt);
+                    break;
+            }
+        };
+
+        if(m_threads && n > UpdateChunk)
+            m_threads->parallelFor(n, UpdateChunk, run);
+        else if(n != 0)
+            run(0, n, 0);
+    }
+
+    /// Threads.
+    void ParticleEngine::setThreadPool(ThreadPool* threads)
+    {
+        m_threads = threads;
+    }
+
+    void ParticleEngine::clear()
+    {
+        m_emitters.clear();
+        m_head = m_tail = m_live = 0;
+    }
+
+    /// Getters.
+    std::size_t ParticleEngine::size() const
+    {
+        return m_tail - m_head;
+    }
+
+    std::size_t ParticleEngine::getEmitterCount() const
+    {
+        return m_emitters.size();
+    }
+
+    const sf::Vertex* ParticleEngine::getVertices() const
+    {
+        return m_vertices.data() + m_head;
+    }
+} // namespace kantan.
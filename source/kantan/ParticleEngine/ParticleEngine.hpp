@@ -0,0 +1,157 @@
+#ifndef KANTAN_PARTICLE_ENGINE
+#define KANTAN_PARTICLE_ENGINE
+
+#include <SFML/Graphics.hpp>
+
+#include "../AabbKernel/AabbKernel.hpp"
+#include "../ThreadPool/ThreadPool.hpp"
+
+#include <vector>
+#include <deque>
+#include <cstddef>
+
+namespace kantan
+{
+    /**
+        ParticleBurst struct.
+        Particles going in random directions from a point, their speed and lifetime picked between bounds.
+    **/
+    struct ParticleBurst
+    {
+        sf::Vector2f center;
+        sf::Color color;
+        std::size_t count;
+
+        // Lifetime of the emitter.
+        sf::Time duration;
+
+        float minSpeed, maxSpeed;
+        sf::Time minLifetime, maxLifetime;
+
+        // Emitters of lower priority are culled first when the particle budget is reached.
+        int priority;
+    };
+
+    /**
+        ParticleEngine class.
+        Particles stored as a structure of arrays (position, velocity, remaining lifetime, color).
+        The update moves them and writes their vertices (position and faded color) in the same pass,
+        4 (SSE) or 8 (AVX2) particles at a time.
+        A particle fades out during the last second of its life and is transparent once dead.
+
+        The particles live in a pool of fixed capacity, used as a ring: each emitter (an explosion for example)
+        is a range of particles added after the newest one, and the oldest emitters expire first.
+        The live particles always are contiguous, so they are drawn in one call: when an emitter does not fit
+        before the end of the pool, the live emitters are compacted at its start, the expired ones being dropped,
+        and if there still is no room the oldest emitters are dropped.
+
+        The number of live particles can be capped under the capacity by a budget: a new emitter going over it
+        culls the live emitters of lower or equal priority, the lowest priority and then the oldest first.
+    **/
+    class ParticleEngine
+    {
+        public:
+            // Ctor, picks the best level available at runtime.
+            explicit ParticleEngine(std::size_t capacity = 65536);
+
+            // Ctor, forces a level (falls back to scalar if the level is not supported).
+            ParticleEngine(std::size_t capacity, SimdLevel level);
+
+            // Level used.
+            SimdLevel getLevel() const;
+
+            // Capacity of the pool (removes all the particles).
+            void setCapacity(std::size_t capacity);
+            std::size_t getCapacity() const;
+
+            // Max number of live particles, at most the capacity (the capacity by default).
+            void setBudget(std::size_t budget);
+            std::size_t getBudget() const;
+
+            // Number of particles of the live emitters.
+            std::size_t getLiveCount() const;
+
+            // Adds an emitter of count particles expiring after the given time, and returns the index of its first particle.
+            // The emitter gets fewer particles if culling the others did not free enough of the budget (see getLastEmitterSize).
+            // Its particles have to be set with setParticle.
+            std::size_t addEmitter(std::size_t count, sf::Time lifetime, int priority = 0);
+
+            // Number of particles of the last emitter added.
+            std::size_t getLastEmitterSize() const;
+
+            // Adds an emitter and spawns a burst in it, 8 particles at a time with AVX2, and returns the index of its first particle.
+            std::size_t addBurst(const ParticleBurst& burst);
+
+            // Seed of the bursts, the same seed gives the same bursts.
+            void setSeed(sf::Uint32 seed);
+
+            // Sets a particle of the last emitter added.
+            void setParticle(std::size_t index, const sf::Vector2f& position, const sf::Vector2f& velocity, sf::Time lifetime, const sf::Color& color);
+
+            // Moves the particles, ages them, updates their vertices and drops the expired emitters.
+            void update(sf::Time elapsed);
+
+            // Sets the threads the update is spread on (none by default).
+            void setThreadPool(ThreadPool* threads);
+
+            // Removes all the particles.
+            void clear();
+
+            // Number of live particles (dead ones of live emitters included) and emitters.
+            std::size_t size() const;
+            std::size_t getEmitterCount() const;
+
+            // Vertices of the live particles, one point per particle (size() of them).
+            const sf::Vertex* getVertices() const;
+
+            // Particles updated per task: about 180 KB of particles and vertices, which stay in a 256 KB L2 cache.
+            static const std::size_t UpdateChunk = 4096;
+
+        protected:
+            // Emitter.
+            struct Emitter
+            {
+                std::size_t begin, count;
+                sf::Time remaining;
+                int priority;
+            };
+
+            // Expires live emitters of at most the given priority until excess particles are freed.
+            void cull(std::size_t excess, int priority);
+
+            // Expires an emitter now.
+            void kill(Emitter& emitter);
+
+            // Moves the live emitters at the start of the pool, dropping the expired ones and
+            // as many of the oldest as needed to leave room for the given number of particles.
+            void compact(std::size_t room);
+
+            // Moves a range of particles.
+            void move(std::size_t from, std::size_t count, std::size_t to);
+
+            SimdLevel m_level;
+
+            // Random numbers of the bursts, the counter is the index of the next particle spawned.
+            sf::Uint32 m_seed, m_counter;
+
+            // Live range of the pool, budget and particles of the live emitters.
+            std::size_t m_capacity, m_head, m_tail, m_budget, m_live;
+
+            // Emitters, the oldest first.
+            std::deque<Emitter> m_emitters;
+
+            // Particles.
+            std::vector<float> m_px, m_py, m_vx, m_vy, m_life;
+
+            // Color of each particle without its alpha, packed like sf::Color in memory.
+            std::vector<sf::Uint32> m_colors;
+
+            // Vertices.
+            std::vector<sf::Vertex> m_vertices;
+
+            // Threads of the update.
+            ThreadPool* m_threads;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_PARTICLE_ENGINE
@@ -0,0 +1,331 @@
+#include "ProjectileBatch.hpp"
+#include "../Entity/Entity.hpp"
+#include "../SweptAabb/SweptAabb.hpp"
+#include "../CollisionMatrix/CollisionMatrix.hpp"
+
+#include <algorithm>
+
+namespace kantan
+{
+    namespace
+    {
+        // Swept test on the y axis of two boxes whose columns overlap: [yA, yA + hA] moves by dA and [yB, yB + hB] by dB.
+        // Same rule as sweepAabb (touching edges do not overlap), the time is in [0, 1[.
+        bool sweepColumn(float yA, float hA, float dA, float yB, float hB, float dB, float& time)
+        {
+            float d = dA - dB;
+            float entry, exit;
+
+            if(d > 0.f)
+            {
+                entry = (yB - (yA + hA)) / d;
+                exit = (yB + hB - yA) / d;
+            }
+            else if(d < 0.f)
+            {
+                entry = (yB + hB - yA) / d;
+                exit = (yB - (yA + hA)) / d;
+            }
+            else
+            {
+                // Overlapping during the whole step, or never.
+                if(!(yA < yB + hB && yB < yA + hA))
+                    return false;
+
+                time = 0.f;
+                return true;
+            }
+
+            if(entry >= exit || entry >= 1.f || exit <= 0.f)
+                return false;
+
+            time = std::max(0.f, entry);
+            return true;
+        }
+    }
+
+    /// Ctor.
+    ProjectileBatch::ProjectileBatch()
+        : m_sorted(true)
+        , m_sync(0)
+    {}
+
+    /// Kinds.
+    void ProjectileBatch::setKind(unsigned int kind, const sf::Vector2f& size, unsigned int layers, unsigned int mask)
+    {
+        if(kind >= m_kinds.size())
+            m_kinds.resize(kind + 1, Kind{0.f, 0.f, 0u, 0u});
+
+        m_kinds[kind] = Kind{size.x, size.y, layers, mask};
+    }
+
+    bool ProjectileBatch::collide(unsigned int kindA, unsigned int kindB) const
+    {
+        return CollisionMatrix::canCollide(m_kinds[kindA].layers, m_kinds[kindA].mask, m_kinds[kindB].layers, m_kinds[kindB].mask);
+    }
+
+    /// Synchronization.
+    void ProjectileBatch::beginSync()
+    {
+        ++m_sync;
+    }
+
+    std::size_t ProjectileBatch::sync(Entity* entity, const sf::Vector2f& position, float velocity, unsigned int kind)
+    {
+        if(kind >= m_kinds.size())
+            setKind(kind, sf::Vector2f(0.f, 0.f), 0u, 0u);
+
+        auto found = m_indices.find(entity->getId());
+        std::size_t index;
+
+        if(found == m_indices.end())
+        {
+            index = m_x.size();
+            m_indices[entity->getId()] = index;
+
+            m_x.push_back(position.x);
+            m_y.push_back(position.y);
+            m_vy.push_back(velocity);
+            m_kind.push_back(kind);
+            m_entities.push_back(entity);
+            m_ids.push_back(entity->getId());
+            m_synced.push_back(m_sync);
+
+            // The next sort puts it at its place.
+            m_order.push_back(static_cast<unsigned int>(index));
+            return index;
+        }
+
+        index = found->second;
+
+        m_x[index] = position.x;
+        m_y[index] = position.y;
+        m_vy[index] = velocity;
+        m_kind[index] = kind;
+        m_synced[index] = m_sync;
+
+        return index;
+    }
+
+    void ProjectileBatch::endSync()
+    {
+        for(std::size_t i(0) ; i < m_x.size() ;)
+        {
+            // The last one takes its place, look at the same index again.
+            if(m_synced[i] != m_sync)
+                removeAt(i);
+            else
+                ++i;
+        }
+    }
+
+    bool ProjectileBatch::remove(Entity* entity)
+    {
+        auto found = m_indices.find(entity->getId());
+
+        if(found == m_indices.end())
+            return false;
+
+        removeAt(found->second);
+        return true;
+    }
+
+    void ProjectileBatch::removeAt(std::size_t index)
+    {
+        const std::size_t last = m_x.size() - 1;
+        m_indices.erase(m_ids[index]);
+
+        if(index != last)
+        {
+            m_x[index] = m_x[last];
+            m_y[index] = m_y[last];
+            m_vy[index] = m_vy[last];
+            m_kind[index] = m_kind[last];
+            m_entities[index] = m_entities[last];
+            m_ids[index] = m_ids[last];
+            m_synced[index] = m_synced[last];
+
+            m_indices[m_ids[index]] = index;
+        }
+
+        m_x.pop_back();
+        m_y.pop_back();
+        m_vy.pop_back();
+        m_kind.pop_back();
+        m_entities.pop_back();
+        m_ids.pop_back();
+        m_synced.pop_back();
+
+        m_sorted = false;
+    }
+
+    void ProjectileBatch::clear()
+    {
+        m_x.clear();
+        m_y.clear();
+        m_vy.clear();
+        m_kind.clear();
+        m_entities.clear();
+        m_ids.clear();
+        m_synced.clear();
+        m_indices.clear();
+        m_order.clear();
+
+        m_sorted = true;
+    }
+
+    /// Projectiles.
+    std::size_t ProjectileBatch::size() const
+    {
+        return m_x.size();
+    }
+
+    Entity* ProjectileBatch::getEntity(std::size_t index) const
+    {
+        return m_entities[index];
+    }
+
+    sf::Vector2f ProjectileBatch::getPosition(std::size_t index) const
+    {
+        return sf::Vector2f(m_x[index], m_y[index]);
+    }
+
+    float ProjectileBatch::getVelocity(std::size_t index) const
+    {
+        return m_vy[index];
+    }
+
+    unsigned int ProjectileBatch::getKind(std::size_t index) const
+    {
+        return m_kind[index];
+    }
+
+    /// Step.
+    void ProjectileBatch::step(float dt, const std::vector<ProjectileTarget>& targets, std::vector<ProjectileContact>& contacts)
+    {
+        const std::size_t n = m_x.size();
+
+        m_contacts.clear();
+
+        // Movements and the rows covered during the step, in passes the compiler can vectorize.
+        m_dy.resize(n);
+        m_top.resize(n);
+        m_bottom.resize(n);
+
+        float extent = 0.f;
+        for(std::size_t i(0) ; i < n ; ++i)
+        {
+            const float height = m_kinds[m_kind[i]].height;
+
+            m_dy[i] = m_vy[i] * dt;
+            m_top[i] = std::min(m_y[i], m_y[i] + m_dy[i]);
+            m_bottom[i] = std::max(m_y[i], m_y[i] + m_dy[i]) + height;
+            extent = std::max(extent, m_bottom[i] - m_top[i]);
+        }
+
+        // Sort by top. The order barely changes from a step to the next, an insertion sort is linear then.
+        // Removals move projectiles to other indices: sort them all again.
+        if(!m_sorted)
+        {
+            m_order.resize(n);
+            for(std::size_t i(0) ; i < n ; ++i)
+                m_order[i] = static_cast<unsigned int>(i);
+
+            std::sort(m_order.begin(), m_order.end(), [this](unsigned int l, unsigned int r)
+            {
+                return m_top[l] < m_top[r];
+            });
+
+            m_sorted = true;
+        }
+
+        for(std::size_t a(1) ; a < n ; ++a)
+        {
+            const unsigned int i = m_order[a];
+            std::size_t b = a;
+
+            for( ; b > 0 && m_top[m_order[b - 1]] > m_top[i] ; --b)
+                m_order[b] = m_order[b - 1];
+
+            m_order[b] = i;
+        }
+
+        // Projectiles against projectiles: the rows overlapping the one of a projectile come right after it,
+        // then the columns must overlap, and the test itself is on the y axis.
+        for(std::size_t a(0) ; a < n ; ++a)
+        {
+            const unsigned int i = m_order[a];
+            const Kind& kindI = m_kinds[m_kind[i]];
+
+            for(std::size_t b(a + 1) ; b < n ; ++b)
+            {
+                const unsigned int j = m_order[b];
+
+                if(m_top[j] >= m_bottom[i])
+                    break;
+
+                const Kind& kindJ = m_kinds[m_kind[j]];
+
+                if(!(m_x[i] < m_x[j] + kindJ.width && m_x[j] < m_x[i] + kindI.width) || !collide(m_kind[i], m_kind[j]))
+                    continue;
+
+                float time;
+                if(sweepColumn(m_y[i], kindI.height, m_dy[i], m_y[j], kindJ.height, m_dy[j], time))
+                {
+                    // The lowest id first, as for any unordered pair.
+                    if(m_ids[i] < m_ids[j])
+                        m_contacts.push_back(ProjectileContact{time, m_entities[i], m_entities[j]});
+                    else
+                        m_contacts.push_back(ProjectileContact{time, m_entities[j], m_entities[i]});
+                }
+            }
+        }
+
+        // Projectiles against the targets: only the ones whose row may cross the area covered by the target.
+        for(const ProjectileTarget& target : targets)
+        {
+            const float left = std::min(target.box.left, target.box.left + target.movement.x);
+            const float right = std::max(target.box.left, target.box.left + target.movement.x) + target.box.width;
+            const float top = std::min(target.box.top, target.box.top + target.movement.y);
+            const float bottom = std::max(target.box.top, target.box.top + target.movement.y) + target.box.height;
+
+            // No row is taller than the extent.
+            auto first = std::lower_bound(m_order.begin(), m_order.end(), top - extent, [this](unsigned int i, float value)
+            {
+                return m_top[i] < value;
+            });
+
+            for(auto itr = first ; itr != m_order.end() && m_top[*itr] < bottom ; ++itr)
+            {
+                const unsigned int i = *itr;
+                const Kind& kind = m_kinds[m_kind[i]];
+
+                if(!(top < m_bottom[i] && m_x[i] < right && left < m_x[i] + kind.width))
+                    continue;
+
+                if(!CollisionMatrix::canCollide(kind.layers, kind.mask, target.layers, target.mask))
+                    continue;
+
+                SweepHit hit;
+                if(sweepAabb(sf::FloatRect(m_x[i], m_y[i], kind.width, kind.height), sf::Vector2f(0.f, m_dy[i]), target.box, target.movement, hit))
+                    m_contacts.push_back(ProjectileContact{hit.time, m_entities[i], target.entity});
+            }
+        }
+
+        // In the order they happened.
+        std::sort(m_contacts.begin(), m_contacts.end(), [](const ProjectileContact& l, const ProjectileContact& r)
+        {
+            if(l.time != r.time)
+                return l.time < r.time;
+            if(l.first->getId() != r.first->getId())
+                return l.first->getId() < r.first->getId();
+            return l.second->getId() < r.second->getId();
+        });
+
+        contacts.insert(contacts.end(), m_contacts.begin(), m_contacts.end());
+
+        // Move.
+        for(std::size_t i(0) ; i < n ; ++i)
+            m_y[i] += m_dy[i];
+    }
+} // namespace kantan.
@@ -0,0 +1,118 @@
+#ifndef KANTAN_PROJECTILE_BATCH
+#define KANTAN_PROJECTILE_BATCH
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    class Entity;
+
+    /**
+        ProjectileTarget struct.
+        A body projectiles can hit: its box at the start of the step, its movement during it and its collision layers.
+    **/
+    struct ProjectileTarget
+    {
+        Entity* entity;
+        sf::FloatRect box;
+        sf::Vector2f movement;
+        unsigned int layers, mask;
+    };
+
+    /**
+        ProjectileContact struct.
+        A projectile meeting another one or a target during the step. first is always a projectile.
+    **/
+    struct ProjectileContact
+    {
+        float time;
+        Entity* first;
+        Entity* second;
+    };
+
+    /**
+        ProjectileBatch class.
+        Non-blocking projectiles moving vertically at a constant velocity, stored in packed arrays (x, y, vy, kind).
+        Their x never changes, so once the pairs are found (a sweep over the projectiles sorted by the top of the rows
+        they cover during the step), two projectiles meet if their columns overlap and the test itself is on the y axis only.
+        The size and the collision layers are shared by the projectiles of a kind.
+    **/
+    class ProjectileBatch
+    {
+        public:
+            // Ctor.
+            ProjectileBatch();
+
+            // Size and collision layers of the projectiles of a kind.
+            void setKind(unsigned int kind, const sf::Vector2f& size, unsigned int layers, unsigned int mask);
+
+            // Starts a synchronization with the entities: the projectiles not synced before endSync are removed.
+            void beginSync();
+
+            // Adds a projectile, or updates it if it is already there. Returns its index.
+            std::size_t sync(Entity* entity, const sf::Vector2f& position, float velocity, unsigned int kind);
+
+            // Removes the projectiles not synced since beginSync.
+            void endSync();
+
+            // Removes a projectile, returns false if it is not there.
+            bool remove(Entity* entity);
+
+            // Removes every projectile.
+            void clear();
+
+            // Projectiles. Indices change when projectiles are removed.
+            std::size_t size() const;
+            Entity* getEntity(std::size_t index) const;
+            sf::Vector2f getPosition(std::size_t index) const;
+            float getVelocity(std::size_t index) const;
+            unsigned int getKind(std::size_t index) const;
+
+            // Finds the contacts of the step (between projectiles, and with the targets) and appends them in time order,
+            // then moves every projectile.
+            void step(float dt, const std::vector<ProjectileTarget>& targets, std::vector<ProjectileContact>& contacts);
+
+        protected:
+            // Shared data of a kind.
+            struct Kind
+            {
+                float width, height;
+                unsigned int layers, mask;
+            };
+
+            // Removes the projectile at the index by moving the last one there.
+            void removeAt(std::size_t index);
+
+            // Returns true if the projectiles of both kinds collide.
+            bool collide(unsigned int kindA, unsigned int kindB) const;
+
+            // Packed projectiles.
+            std::vector<float> m_x, m_y, m_vy;
+            std::vector<unsigned int> m_kind;
+            std::vector<Entity*> m_entities;
+            std::vector<unsigned int> m_ids;
+            std::vector<unsigned int> m_synced;
+
+            // Index of each projectile, by entity id.
+            std::unordered_map<unsigned int, std::size_t> m_indices;
+
+            std::vector<Kind> m_kinds;
+
+            // Projectiles sorted by the top of their row, kept from a step to the next (sorted again after removals).
+            std::vector<unsigned int> m_order;
+            bool m_sorted;
+
+            unsigned int m_sync;
+
+            // Movement of each projectile during the step, the rows it covers, and the contacts found.
+            std::vector<float> m_dy;
+            std::vector<float> m_top, m_bottom;
+            std::vector<ProjectileContact> m_contacts;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_PROJECTILE_BATCH
@@ -0,0 +1,72 @@
+#include "RenderBackend.hpp"
+
+namespace kantan
+{
+    /// Ctor.
+    RenderBackend::RenderBackend(const RenderResources* resources)
+        : m_resources(resources)
+    {}
+
+    /// Execution.
+    void RenderBackend::execute(const CommandBuffer& buffer, sf::RenderTarget& target, sf::RenderStates states)
+    {
+        const std::vector<RenderCommand>& commands = buffer.getCommands();
+        const std::vector<sf::Vertex>& vertices = buffer.getVertices();
+        const std::vector<sf::Uint32>& characters = buffer.getCharacters();
+
+        // The queue keeps pointers to the texts: they are all allocated first.
+        std::size_t textCount = 0;
+        for(const RenderCommand& command : commands)
+        {
+            if(command.type == RenderCommand::Text)
+                ++textCount;
+        }
+
+        if(m_texts.size() < textCount)
+            m_texts.resize(textCount);
+
+        std::size_t textIndex = 0;
+        for(const RenderCommand& command : commands)
+        {
+            if(command.type == RenderCommand::Text)
+            {
+                const sf::Font* font = m_resources->getFont(command.resource);
+                sf::Text& text = m_texts[textIndex++];
+
+                // A text needs its font.
+                if(!font)
+                    continue;
+
+                // sf::Text only rebuilds its geometry when one of these changes.
+                text.setFont(*font);
+                text.setString(sf::String::fromUtf32(characters.begin() + command.first, characters.begin() + command.first + command.count));
+                text.setCharacterSize(command.characterSize);
+                text.setStyle(command.style);
+                text.setFillColor(sf::Color(command.color));
+                text.setPosition(command.x, command.y);
+
+                m_queue.submit(text, command.layer, command.depth);
+            }
+            else if(command.type == RenderCommand::Drawable)
+            {
+                const sf::Drawable* drawable = m_resources->getDrawable(command.resource);
+
+                if(drawable)
+                    m_queue.submit(*drawable, command.layer, command.depth);
+            }
+            else
+            {
+                m_queue.submit(vertices.data() + command.first, command.count, static_cast<sf::PrimitiveType>(command.primitive),
+                               m_resources->getTexture(command.resource), command.layer, command.depth);
+            }
+        }
+
+        m_queue.flush(target, states);
+    }
+
+    /// Getters.
+    std::size_t RenderBackend::getDrawCount() const
+    {
+        return m_queue.getDrawCount();
+    }
+} // namespace kantan.
@@ -0,0 +1,41 @@
+#ifndef KANTAN_RENDER_BACKEND
+#define KANTAN_RENDER_BACKEND
+
+#include <SFML/Graphics.hpp>
+
+#include "../CommandBuffer/CommandBuffer.hpp"
+#include "../RenderQueue/RenderQueue.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        RenderBackend class.
+        Executes a command buffer on a render target: the commands go through a render queue,
+        so they are drawn by layer then texture whatever the order they were recorded in.
+    **/
+    class RenderBackend
+    {
+        public:
+            // Ctor, the resources give the textures and the fonts of the ids recorded.
+            explicit RenderBackend(const RenderResources* resources);
+
+            // Draws the commands of the buffer, which is left as it is.
+            void execute(const CommandBuffer& buffer, sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default);
+
+            // Number of draw calls of the last execution.
+            std::size_t getDrawCount() const;
+
+        protected:
+            const RenderResources* m_resources;
+
+            RenderQueue m_queue;
+
+            // Texts of the text commands, kept between the executions so their geometry is only rebuilt on change.
+            std::vector<sf::Text> m_texts;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_RENDER_BACKEND
@@ -0,0 +1,202 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+namespace kantan
+{
+    /// Sort.
+    void radixSort(std::vector<RenderKey>& keys, std::vector<RenderKey>& scratch)
+    {
+        const std::size_t n = keys.size();
+        scratch.resize(n);
+
+        for(unsigned int shift(0) ; shift < 64 ; shift += 8)
+        {
+            std::size_t counts[256] = {0};
+            for(const RenderKey& key : keys)
+                ++counts[(key.key >> shift) & 0xFF];
+
+            // Every key has the same byte here, nothing moves.
+            if(n == 0 || counts[(keys[0].key >> shift) & 0xFF] == n)
+                continue;
+
+            std::size_t offset = 0;
+            for(std::size_t& count : counts)
+            {
+                std::size_t bucket = count;
+                count = offset;
+                offset += bucket;
+            }
+
+            for(const RenderKey& key : keys)
+                scratch[counts[(key.key >> shift) & 0xFF]++] = key;
+
+            keys.swap(scratch);
+        }
+    }
+
+    /// Quads.
+    void appendSpriteQuad(const sf::Sprite& sprite, std::vector<sf::Vertex>& vertices)
+    {
+        const sf::FloatRect bounds = sprite.getLocalBounds();
+        const sf::FloatRect rect(sprite.getTextureRect());
+        const sf::Transform& transform = sprite.getTransform();
+        const sf::Color& color = sprite.getColor();
+
+        vertices.push_back(sf::Vertex(transform.transformPoint(sf::Vector2f(0.f, 0.f)), color, sf::Vector2f(rect.left, rect.top)));
+        vertices.push_back(sf::Vertex(transform.transformPoint(sf::Vector2f(bounds.width, 0.f)), color, sf::Vector2f(rect.left + rect.width, rect.top)));
+        vertices.push_back(sf::Vertex(transform.transformPoint(sf::Vector2f(bounds.width, bounds.height)), color, sf::Vector2f(rect.left + rect.width, rect.top + rect.height)));
+        vertices.push_back(sf::Vertex(transform.transformPoint(sf::Vector2f(0.f, bounds.height)), color, sf::Vector2f(rect.left, rect.top + rect.height)));
+    }
+
+    /// Ctor.
+    RenderQueue::RenderQueue()
+        : m_drawCount(0)
+    {}
+
+    /// Keys.
+    std::uint64_t RenderQueue::makeKey(unsigned int layer, std::uint32_t texture, std::uint32_t depth)
+    {
+        return (static_cast<std::uint64_t>(layer & 0xFF) << 56) | (static_cast<std::uint64_t>(texture & 0xFFFFFF) << 32) | depth;
+    }
+
+    std::uint32_t RenderQueue::getTextureId(const sf::Texture* texture)
+    {
+        if(!texture)
+            return 0;
+
+        auto found = m_textureIds.find(texture);
+        if(found != m_textureIds.end())
+            return found->second;
+
+        std::uint32_t id = static_cast<std::uint32_t>(m_textureIds.size()) + 1;
+        m_textureIds[texture] = id;
+        return id;
+    }
+
+    /// Items.
+    void RenderQueue::submit(const sf::Sprite& sprite, unsigned int layer, std::uint32_t depth)
+    {
+        Item item = Item();
+        item.type = ItemType::Quad;
+        item.texture = sprite.getTexture();
+        item.first = m_quads.size();
+        item.count = 4;
+
+        appendSpriteQuad(sprite, m_quads);
+
+        push(item, makeKey(layer, getTextureId(item.texture), depth));
+    }
+
+    void RenderQueue::submit(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::Texture* texture, unsigned int layer, std::uint32_t depth)
+    {
+        if(count == 0)
+            return;
+
+        Item item = Item();
+        item.type = ItemType::Vertices;
+        item.texture = texture;
+        item.vertices = vertices;
+        item.count = count;
+        item.primitive = type;
+
+        push(item, makeKey(layer, getTextureId(texture), depth));
+    }
+
+    void RenderQueue::submit(const sf::Drawable& drawable, unsigned int layer, std::uint32_t depth)
+    {
+        Item item = Item();
+        item.type = ItemType::Drawable;
+        item.drawable = &drawable;
+
+        push(item, makeKey(layer, DrawableTexture, depth));
+    }
+
+    void RenderQueue::push(const Item& item, std::uint64_t key)
+    {
+        m_keys.push_back(RenderKey{key, static_cast<std::uint32_t>(m_items.size())});
+        m_items.push_back(item);
+    }
+
+    bool RenderQueue::isQuads(const Item& item) const
+    {
+        return item.type == ItemType::Quad || (item.type == ItemType::Vertices && item.primitive == sf::Quads);
+    }
+
+    const sf::Vertex* RenderQueue::getQuadVertices(const Item& item) const
+    {
+        return item.type == ItemType::Quad ? m_quads.data() + item.first : item.vertices;
+    }
+
+    /// Flush.
+    void RenderQueue::flush(sf::RenderTarget& target, sf::RenderStates states)
+    {
+        radixSort(m_keys, m_scratch);
+        m_drawCount = 0;
+
+        for(std::size_t first(0), last(0) ; first < m_keys.size() ; first = last)
+        {
+            const Item& item = m_items[m_keys[first].index];
+            last = first + 1;
+
+            sf::RenderStates itemStates = states;
+
+            if(item.type == ItemType::Drawable)
+            {
+                target.draw(*item.drawable, itemStates);
+            }
+            else if(!isQuads(item))
+            {
+                itemStates.texture = item.texture;
+                target.draw(item.vertices, item.count, item.primitive, itemStates);
+            }
+            else
+            {
+                // The quads of a texture that follow each other, in one call.
+                while(last < m_keys.size() && isQuads(m_items[m_keys[last].index]) && m_items[m_keys[last].index].texture == item.texture)
+                    ++last;
+
+                itemStates.texture = item.texture;
+
+                if(last == first + 1)
+                {
+                    target.draw(getQuadVertices(item), item.count, sf::Quads, itemStates);
+                }
+                else
+                {
+                    m_merged.clear();
+                    for(std::size_t i(first) ; i < last ; ++i)
+                    {
+                        const Item& quads = m_items[m_keys[i].index];
+                        const sf::Vertex* vertices = getQuadVertices(quads);
+                        m_merged.insert(m_merged.end(), vertices, vertices + quads.count);
+                    }
+
+                    target.draw(m_merged.data(), m_merged.size(), sf::Quads, itemStates);
+                }
+            }
+
+            ++m_drawCount;
+        }
+
+        clear();
+    }
+
+    void RenderQueue::clear()
+    {
+        m_items.clear();
+        m_keys.clear();
+        m_quads.clear();
+    }
+
+    /// Getters.
+    std::size_t RenderQueue::getItemCount() const
+    {
+        return m_items.size();
+    }
+
+    std::size_t RenderQueue::getDrawCount() const
+    {
+        return m_drawCount;
+    }
+} // namespace kantan.
@@ -0,0 +1,109 @@
+#ifndef KANTAN_RENDER_QUEUE
+#define KANTAN_RENDER_QUEUE
+
+#include <SFML/Graphics.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        RenderKey struct.
+        Key of a key / index pair sorted by radixSort.
+    **/
+    struct RenderKey
+    {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    // Sorts the keys in increasing order, keeping the order of equal keys, 8 bits per pass.
+    // The passes on bytes that are the same for every key are skipped. scratch is used as the second buffer.
+    void radixSort(std::vector<RenderKey>& keys, std::vector<RenderKey>& scratch);
+
+    // Appends the 4 vertices of the quad of a sprite, transformed, like sf::Sprite draws it.
+    void appendSpriteQuad(const sf::Sprite& sprite, std::vector<sf::Vertex>& vertices);
+
+    /**
+        RenderQueue class.
+        Draw items submitted by the systems during a frame, each with a 64-bit sort key: the layer (8 bits),
+        then the texture (24 bits), then a depth (32 bits). flush() sorts them once and draws them in key order,
+        the items of a layer being grouped by texture so the consecutive quads of a texture (sprites or sf::Quads
+        vertices) are drawn in one call.
+        Items with the same key are drawn in the order they were submitted.
+    **/
+    class RenderQueue
+    {
+        public:
+            // Texture part of the key of the drawables, drawn after the textured items of their layer.
+            static const std::uint32_t DrawableTexture = 0xFFFFFF;
+
+            // Ctor.
+            RenderQueue();
+
+            // Builds a sort key.
+            static std::uint64_t makeKey(unsigned int layer, std::uint32_t texture, std::uint32_t depth);
+
+            // Returns the texture part of the key of a texture (0 for none), numbered in the order they are first seen.
+            std::uint32_t getTextureId(const sf::Texture* texture);
+
+            // Submits the quad of a sprite (copied).
+            void submit(const sf::Sprite& sprite, unsigned int layer, std::uint32_t depth = 0);
+
+            // Submits vertices, which must stay valid until flush.
+            void submit(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type, const sf::Texture* texture, unsigned int layer, std::uint32_t depth = 0);
+
+            // Submits a drawable, which must stay valid until flush.
+            void submit(const sf::Drawable& drawable, unsigned int layer, std::uint32_t depth = 0);
+
+            // Sorts the items, draws them and empties the queue.
+            void flush(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default);
+
+            // Empties the queue without drawing.
+            void clear();
+
+            // Number of items submitted, and of draw calls of the last flush.
+            std::size_t getItemCount() const;
+            std::size_t getDrawCount() const;
+
+        protected:
+            // Item.
+            enum class ItemType {Quad, Vertices, Drawable};
+
+            struct Item
+            {
+                ItemType type;
+                const sf::Texture* texture;
+
+                // Quad: first of its 4 vertices in m_quads. Vertices: the vertices and their primitive.
+                std::size_t first, count;
+                const sf::Vertex* vertices;
+                sf::PrimitiveType primitive;
+
+                const sf::Drawable* drawable;
+            };
+
+            // Adds an item with its key.
+            void push(const Item& item, std::uint64_t key);
+
+            // Returns true if the item is made of quads that can be drawn with others, and their first vertex.
+            bool isQuads(const Item& item) const;
+            const sf::Vertex* getQuadVertices(const Item& item) const;
+
+            std::vector<Item> m_items;
+            std::vector<RenderKey> m_keys, m_scratch;
+
+            // Vertices of the quads submitted, and of the quads drawn together.
+            std::vector<sf::Vertex> m_quads, m_merged;
+
+            // Texture ids.
+            std::unordered_map<const sf::Texture*, std::uint32_t> m_textureIds;
+
+            std::size_t m_drawCount;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_RENDER_QUEUE
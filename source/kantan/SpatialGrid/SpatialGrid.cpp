@@ -0,0 +1,397 @@
+#include "SpatialGrid.hpp"
+#include "../Entity/Entity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace kantan
+{
+    namespace
+    {
+        // Rectangle with a positive size.
+        sf::FloatRect normalize(const sf::FloatRect& box)
+        {
+            float left = std::min(box.left, box.left + box.width);
+            float top = std::min(box.top, box.top + box.height);
+
+            return sf::FloatRect(left, top, std::abs(box.width), std::abs(box.height));
+        }
+
+        // Squared distance from a point to a box, 0 if it is inside.
+        float getDistanceSquared(const sf::Vector2f& point, const sf::FloatRect& box)
+        {
+            float dx = std::max(std::max(box.left - point.x, 0.f), point.x - (box.left + box.width));
+            float dy = std::max(std::max(box.top - point.y, 0.f), point.y - (box.top + box.height));
+
+            return dx * dx + dy * dy;
+        }
+
+        // Slab test: distance along the (unit) ray where it enters the box, 0 if it starts in it.
+        // A ray sliding along an edge does not enter the box.
+        bool intersectRay(const sf::Vector2f& origin, const sf::Vector2f& direction, const sf::FloatRect& box, float& distance)
+        {
+            float entry = 0.f;
+            float exit = std::numeric_limits<float>::infinity();
+
+            const float origins[2] = {origin.x, origin.y};
+            const float directions[2] = {direction.x, direction.y};
+            const float mins[2] = {box.left, box.top};
+            const float maxs[2] = {box.left + box.width, box.top + box.height};
+
+            for(int axis(0) ; axis < 2 ; ++axis)
+            {
+                if(directions[axis] == 0.f)
+                {
+                    if(!(mins[axis] < origins[axis] && origins[axis] < maxs[axis]))
+                        return false;
+
+                    continue;
+                }
+
+                float near = (mins[axis] - origins[axis]) / directions[axis];
+                float far = (maxs[axis] - origins[axis]) / directions[axis];
+
+                if(near > far)
+                    std::swap(near, far);
+
+                entry = std::max(entry, near);
+                exit = std::min(exit, far);
+            }
+
+            if(!(entry < exit))
+                return false;
+
+            distance = entry;
+            return true;
+        }
+    }
+
+    /// Filter.
+    SpatialFilter::SpatialFilter(unsigned int mask, const std::string& component)
+        : mask(mask)
+        , component(component)
+    {}
+
+    /// Ctor.
+    SpatialGrid::SpatialGrid(float cellSize)
+        : m_cellSize(cellSize)
+        , m_removed(0)
+        , m_minCellX(0)
+        , m_minCellY(0)
+        , m_maxCellX(-1)
+        , m_maxCellY(-1)
+    {}
+
+    /// Cells.
+    void SpatialGrid::setCellSize(float cellSize)
+    {
+        m_cellSize = cellSize;
+        m_cells.clear();
+        clear();
+    }
+
+    float SpatialGrid::getCellSize() const
+    {
+        return m_cellSize;
+    }
+
+    int SpatialGrid::getCell(float coordinate) const
+    {
+        // Clamped, so the cells around it can be computed without overflow.
+        const float limit = static_cast<float>(1 << 29);
+        float cell = std::floor(coordinate / m_cellSize);
+
+        return static_cast<int>(std::max(-limit, std::min(limit, cell)));
+    }
+
+    std::uint64_t SpatialGrid::getKey(int x, int y)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    const std::vector<unsigned int>* SpatialGrid::getItems(int x, int y) const
+    {
+        auto found = m_cells.find(getKey(x, y));
+
+        if(found == m_cells.end() || found->second.empty())
+            return nullptr;
+
+        return &found->second;
+    }
+
+    bool SpatialGrid::accepts(unsigned int item, const SpatialFilter& filter) const
+    {
+        if((m_layers[item] & filter.mask) == 0)
+            return false;
+
+        return filter.component.empty() || m_entities[item]->hasComponent(filter.component);
+    }
+
+    /// Content.
+    void SpatialGrid::clear()
+    {
+        // Keep the cells and their memory, the same ones are filled again next step.
+        for(auto& cell : m_cells)
+            cell.second.clear();
+
+        m_entities.clear();
+        m_boxes.clear();
+        m_layers.clear();
+        m_removed = 0;
+
+        m_minCellX = m_minCellY = 0;
+        m_maxCellX = m_maxCellY = -1;
+    }
+
+    void SpatialGrid::insert(Entity* entity, const sf::FloatRect& box, unsigned int layers)
+    {
+        sf::FloatRect bounds = normalize(box);
+        unsigned int item = static_cast<unsigned int>(m_entities.size());
+
+        m_entities.push_back(entity);
+        m_boxes.push_back(bounds);
+        m_layers.push_back(layers);
+
+        int x0 = getCell(bounds.left), x1 = getCell(bounds.left + bounds.width);
+        int y0 = getCell(bounds.top), y1 = getCell(bounds.top + bounds.height);
+
+        for(int y(y0) ; y <= y1 ; ++y)
+            for(int x(x0) ; x <= x1 ; ++x)
+                m_cells[getKey(x, y)].push_back(item);
+
+        if(item == 0)
+        {
+            m_minCellX = x0;
+            m_minCellY = y0;
+            m_maxCellX = x1;
+            m_maxCellY = y1;
+        }
+        else
+        {
+            m_minCellX = std::min(m_minCellX, x0);
+            m_minCellY = std::min(m_minCellY, y0);
+            m_maxCellX = std::max(m_maxCellX, x1);
+            m_maxCellY = std::max(m_maxCellY, y1);
+        }
+    }
+
+    void SpatialGrid::remove(Entity* entity)
+    {
+        if(!entity)
+            return;
+
+        for(unsigned int item(0) ; item < m_entities.size() ; ++item)
+        {
+            if(m_entities[item] != entity)
+                continue;
+
+            // Out of its cells, the queries never see it again. Its slot stays, so the other items keep their index.
+            const sf::FloatRect& bounds = m_boxes[item];
+            int x0 = getCell(bounds.left), x1 = getCell(bounds.left + bounds.width);
+            int y0 = getCell(bounds.top), y1 = getCell(bounds.top + bounds.height);
+
+            for(int y(y0) ; y <= y1 ; ++y)
+            {
+                for(int x(x0) ; x <= x1 ; ++x)
+                {
+                    std::vector<unsigned int>& cell = m_cells[getKey(x, y)];
+                    cell.erase(std::remove(cell.begin(), cell.end(), item), cell.end());
+                }
+            }
+
+            m_entities[item] = nullptr;
+            ++m_removed;
+        }
+    }
+
+    std::size_t SpatialGrid::size() const
+    {
+        return m_entities.size() - m_removed;
+    }
+
+    /// Region.
+    std::size_t SpatialGrid::queryRegion(const sf::FloatRect& region, std::vector<Entity*>& results, const SpatialFilter& filter) const
+    {
+        const std::size_t before = results.size();
+        const sf::FloatRect bounds = normalize(region);
+
+        int x0 = std::max(getCell(bounds.left), m_minCellX), x1 = std::min(getCell(bounds.left + bounds.width), m_maxCellX);
+        int y0 = std::max(getCell(bounds.top), m_minCellY), y1 = std::min(getCell(bounds.top + bounds.height), m_maxCellY);
+
+        for(int y(y0) ; y <= y1 ; ++y)
+        {
+            for(int x(x0) ; x <= x1 ; ++x)
+            {
+                const std::vector<unsigned int>* items = getItems(x, y);
+
+                if(!items)
+                    continue;
+
+                for(unsigned int item : *items)
+                {
+                    const sf::FloatRect& box = m_boxes[item];
+
+                    if(!(bounds.left < box.left + box.width && box.left < bounds.left + bounds.width &&
+                         bounds.top < box.top + box.height && box.top < bounds.top + bounds.height))
+                        continue;
+
+                    // A box in several cells is only reported by the first of them in the region.
+                    if(std::max(getCell(box.left), x0) != x || std::max(getCell(box.top), y0) != y)
+                        continue;
+
+                    if(accepts(item, filter))
+                        results.push_back(m_entities[item]);
+                }
+            }
+        }
+
+        return results.size() - before;
+    }
+
+    /// Ray.
+    bool SpatialGrid::raycast(const sf::Vector2f& origin, const sf::Vector2f& direction, RaycastHit& hit, float maxDistance, const SpatialFilter& filter) const
+    {
+        float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+
+        if(m_entities.empty() || length == 0.f)
+            return false;
+
+        const sf::Vector2f d = direction / length;
+
+        // Only walk through the part of the ray over the occupied cells.
+        sf::FloatRect occupied(m_minCellX * m_cellSize, m_minCellY * m_cellSize,
+                               (m_maxCellX - m_minCellX + 1) * m_cellSize, (m_maxCellY - m_minCellY + 1) * m_cellSize);
+        float start = 0.f;
+
+        if(!occupied.contains(origin) && (!intersectRay(origin, d, occupied, start) || start > maxDistance))
+            return false;
+
+        sf::Vector2f current = origin + d * start;
+        int x = getCell(current.x), y = getCell(current.y);
+
+        // Grid traversal: distance to the next vertical and horizontal cell borders, and between two of them.
+        const int stepX = d.x > 0.f ? 1 : (d.x < 0.f ? -1 : 0);
+        const int stepY = d.y > 0.f ? 1 : (d.y < 0.f ? -1 : 0);
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        float nextX = stepX == 0 ? infinity : ((x + (stepX > 0 ? 1 : 0)) * m_cellSize - origin.x) / d.x;
+        float nextY = stepY == 0 ? infinity : ((y + (stepY > 0 ? 1 : 0)) * m_cellSize - origin.y) / d.y;
+        const float deltaX = stepX == 0 ? infinity : m_cellSize / std::abs(d.x);
+        const float deltaY = stepY == 0 ? infinity : m_cellSize / std::abs(d.y);
+
+        bool found = false;
+        float best = maxDistance;
+
+        while(true)
+        {
+            if(const std::vector<unsigned int>* items = getItems(x, y))
+            {
+                for(unsigned int item : *items)
+                {
+                    float distance;
+                    if(intersectRay(origin, d, m_boxes[item], distance) && (found ? distance < best : distance <= best) && accepts(item, filter))
+                    {
+                        found = true;
+                        best = distance;
+
+                        hit.entity = m_entities[item];
+                        hit.distance = distance;
+                    }
+                }
+            }
+
+            // A box may stick out of its cell: the hit is only sure once the ray left the cells before it.
+            float exit = std::min(nextX, nextY);
+            if((found && best <= exit) || exit > maxDistance)
+                break;
+
+            if(nextX < nextY)
+            {
+                x += stepX;
+                nextX += deltaX;
+            }
+            else
+            {
+                y += stepY;
+                nextY += deltaY;
+            }
+
+            if(x < m_minCellX - 1 || x > m_maxCellX + 1 || y < m_minCellY - 1 || y > m_maxCellY + 1)
+                break;
+        }
+
+        if(found)
+            hit.point = origin + d * hit.distance;
+
+        return found;
+    }
+
+    /// Nearest.
+    std::size_t SpatialGrid::queryNearest(const sf::Vector2f& point, std::size_t k, std::vector<Entity*>& results, float maxDistance, const SpatialFilter& filter) const
+    {
+        if(k == 0 || m_entities.empty())
+            return 0;
+
+        const int cx = getCell(point.x), cy = getCell(point.y);
+        const float maxDistanceSquared = maxDistance * maxDistance;
+
+        // Squared distance and box of the candidates.
+        std::vector<std::pair<float, unsigned int>> candidates;
+
+        // Rings of cells around the point, from the first one reaching the occupied cells.
+        int ring = std::max(std::max(m_minCellX - cx, cx - m_maxCellX), std::max(m_minCellY - cy, cy - m_maxCellY));
+        ring = std::max(ring, 0);
+
+        while(true)
+        {
+            for(int y(std::max(cy - ring, m_minCellY)) ; y <= std::min(cy + ring, m_maxCellY) ; ++y)
+            {
+                // Whole rows at the top and bottom of the ring, only both ends in between.
+                bool edge = (y == cy - ring || y == cy + ring);
+                int step = edge || ring == 0 ? 1 : 2 * ring;
+
+                for(int x(cx - ring) ; x <= cx + ring ; x += step)
+                {
+                    if(x < m_minCellX || x > m_maxCellX)
+                        continue;
+
+                    const std::vector<unsigned int>* items = getItems(x, y);
+
+                    if(!items)
+                        continue;
+
+                    for(unsigned int item : *items)
+                    {
+                        float distance = getDistanceSquared(point, m_boxes[item]);
+
+                        if(distance <= maxDistanceSquared && accepts(item, filter))
+                            candidates.push_back(std::make_pair(distance, item));
+                    }
+                }
+            }
+
+            // A box in several cells may have been found several times.
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            // Every box not found yet is farther than the ring.
+            float covered = ring * m_cellSize;
+            std::size_t sure = std::upper_bound(candidates.begin(), candidates.end(), std::make_pair(covered * covered, ~0u)) - candidates.begin();
+
+            bool everything = cx - ring <= m_minCellX && cx + ring >= m_maxCellX && cy - ring <= m_minCellY && cy + ring >= m_maxCellY;
+
+            if(sure >= k || everything || covered > maxDistance)
+                break;
+
+            ++ring;
+        }
+
+        std::size_t count = std::min(k, candidates.size());
+
+        for(std::size_t i(0) ; i < count ; ++i)
+            results.push_back(m_entities[candidates[i].second]);
+
+        return count;
+    }
+} // namespace kantan.
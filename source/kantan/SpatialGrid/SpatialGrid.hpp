@@ -0,0 +1,108 @@
+#ifndef KANTAN_SPATIAL_GRID
+#define KANTAN_SPATIAL_GRID
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kantan
+{
+    class Entity;
+
+    /**
+        SpatialFilter struct.
+        Which entities a spatial query may return: the ones on one of the layers of the mask,
+        and with the given component (any entity if the name is empty).
+    **/
+    struct SpatialFilter
+    {
+        SpatialFilter(unsigned int mask = ~0u, const std::string& component = "");
+
+        unsigned int mask;
+        std::string component;
+    };
+
+    /**
+        RaycastHit struct.
+        First entity met by a ray, where and how far from the origin.
+    **/
+    struct RaycastHit
+    {
+        Entity* entity;
+        sf::Vector2f point;
+        float distance;
+    };
+
+    /**
+        SpatialGrid class.
+        Uniform grid of square cells indexing the boxes of entities, for region, ray and nearest entities queries
+        that only look at the cells around the query instead of every entity.
+        A box is in every cell it covers. The grid is meant to be rebuilt each step, cleared cells keep their memory;
+        the entities destroyed in between are removed from it.
+    **/
+    class SpatialGrid
+    {
+        public:
+            // Ctor.
+            SpatialGrid(float cellSize = 128.f);
+
+            // Size of the cells (clears the grid).
+            void setCellSize(float cellSize);
+            float getCellSize() const;
+
+            // Removes every box.
+            void clear();
+
+            // Adds the box of an entity, on the given collision layers.
+            void insert(Entity* entity, const sf::FloatRect& box, unsigned int layers = ~0u);
+
+            // Removes the boxes of an entity, so no query returns it anymore.
+            void remove(Entity* entity);
+
+            // Number of boxes.
+            std::size_t size() const;
+
+            // Appends the entities whose box intersects the region (touching edges do not count), each once.
+            std::size_t queryRegion(const sf::FloatRect& region, std::vector<Entity*>& results, const SpatialFilter& filter = SpatialFilter()) const;
+
+            // Finds the first box crossed by the ray, up to the given distance. Returns false if there is none.
+            bool raycast(const sf::Vector2f& origin, const sf::Vector2f& direction, RaycastHit& hit,
+                         float maxDistance = std::numeric_limits<float>::infinity(), const SpatialFilter& filter = SpatialFilter()) const;
+
+            // Appends the (at most) k entities whose box is the closest to the point, closest first.
+            std::size_t queryNearest(const sf::Vector2f& point, std::size_t k, std::vector<Entity*>& results,
+                                     float maxDistance = std::numeric_limits<float>::infinity(), const SpatialFilter& filter = SpatialFilter()) const;
+
+        protected:
+            // Cell containing a coordinate.
+            int getCell(float coordinate) const;
+
+            // Key of a cell in the map.
+            static std::uint64_t getKey(int x, int y);
+
+            // Boxes in a cell, nullptr if it has none.
+            const std::vector<unsigned int>* getItems(int x, int y) const;
+
+            // Returns true if the filter accepts the box.
+            bool accepts(unsigned int item, const SpatialFilter& filter) const;
+
+            float m_cellSize;
+
+            // Boxes, their entity being nullptr once removed.
+            std::vector<Entity*> m_entities;
+            std::vector<sf::FloatRect> m_boxes;
+            std::vector<unsigned int> m_layers;
+            std::size_t m_removed;
+
+            // Cells, and the range of the ones holding boxes.
+            std::unordered_map<std::uint64_t, std::vector<unsigned int>> m_cells;
+            int m_minCellX, m_minCellY, m_maxCellX, m_maxCellY;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_SPATIAL_GRID
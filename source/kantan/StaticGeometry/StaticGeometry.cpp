@@ -0,0 +1,108 @@
+#include "StaticGeometry.hpp"
+
+#include <algorithm>
+
+namespace kantan
+{
+    /// Ctor.
+    StaticGeometry::StaticGeometry()
+        : m_texture(nullptr)
+        , m_buffer(sf::Quads, sf::VertexBuffer::Static)
+        , m_buffered(false)
+        , m_uploaded(0)
+        , m_changedBegin(0)
+        , m_changedEnd(0)
+    {}
+
+    void StaticGeometry::setTexture(const sf::Texture* texture)
+    {
+        m_texture = texture;
+    }
+
+    /// Quads.
+    std::size_t StaticGeometry::addQuad(const sf::FloatRect& rect, const sf::IntRect& textureRect, const sf::Color& color)
+    {
+        m_vertices.push_back(sf::Vertex(sf::Vector2f(rect.left, rect.top), color));
+        m_vertices.push_back(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), color));
+        m_vertices.push_back(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), color));
+        m_vertices.push_back(sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), color));
+
+        std::size_t quad = m_vertices.size() / 4 - 1;
+        setTextureRect(quad, textureRect);
+
+        return quad;
+    }
+
+    void StaticGeometry::setTextureRect(std::size_t quad, const sf::IntRect& textureRect)
+    {
+        const sf::FloatRect rect(textureRect);
+        sf::Vertex* vertices = &m_vertices[quad * 4];
+
+        vertices[0].texCoords = sf::Vector2f(rect.left, rect.top);
+        vertices[1].texCoords = sf::Vector2f(rect.left + rect.width, rect.top);
+        vertices[2].texCoords = sf::Vector2f(rect.left + rect.width, rect.top + rect.height);
+        vertices[3].texCoords = sf::Vector2f(rect.left, rect.top + rect.height);
+
+        if(m_changedBegin == m_changedEnd)
+        {
+            m_changedBegin = quad * 4;
+            m_changedEnd = quad * 4 + 4;
+        }
+        else
+        {
+            m_changedBegin = std::min(m_changedBegin, quad * 4);
+            m_changedEnd = std::max(m_changedEnd, quad * 4 + 4);
+        }
+    }
+
+    /// Upload.
+    void StaticGeometry::update()
+    {
+        if(m_uploaded != m_vertices.size())
+        {
+            // New quads, the whole buffer is created again.
+            m_buffered = sf::VertexBuffer::isAvailable() && m_buffer.create(m_vertices.size()) && m_buffer.update(m_vertices.data());
+            m_uploaded = m_buffered ? m_vertices.size() : 0;
+        }
+        else if(m_buffered && m_changedBegin != m_changedEnd)
+        {
+            // Vertices are interleaved, so the texture coordinates go up with their positions.
+            m_buffer.update(&m_vertices[m_changedBegin], m_changedEnd - m_changedBegin, static_cast<unsigned int>(m_changedBegin));
+        }
+
+        m_changedBegin = m_changedEnd = 0;
+    }
+
+    void StaticGeometry::clear()
+    {
+        m_vertices.clear();
+        m_buffered = false;
+        m_uploaded = 0;
+        m_changedBegin = m_changedEnd = 0;
+    }
+
+    /// Getters.
+    std::size_t StaticGeometry::getQuadCount() const
+    {
+        return m_vertices.size() / 4;
+    }
+
+    bool StaticGeometry::isBuffered() const
+    {
+        return m_buffered && m_uploaded == m_vertices.size();
+    }
+
+    /// Draw.
+    void StaticGeometry::draw(sf::RenderTarget& target, sf::RenderStates states) const
+    {
+        if(m_vertices.empty())
+            return;
+
+        states.texture = m_texture;
+
+        if(isBuffered())
+            target.draw(m_buffer, states);
+        else
+            target.draw(m_vertices.data(), m_vertices.size(), sf::Quads, states);
+    }
+} // namespace kantan.
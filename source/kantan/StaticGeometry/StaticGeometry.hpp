@@ -0,0 +1,61 @@
+#ifndef KANTAN_STATIC_GEOMETRY
+#define KANTAN_STATIC_GEOMETRY
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        StaticGeometry class.
+        Quads that never move, sharing a texture, uploaded once to a static sf::VertexBuffer and drawn in one call.
+        Only their texture rectangles change (animations): update() then uploads the range of the quads changed.
+        Without vertex buffer support, the quads are drawn from memory as a vertex array.
+    **/
+    class StaticGeometry : public sf::Drawable
+    {
+        public:
+            // Ctor.
+            StaticGeometry();
+
+            // Sets the texture of the quads.
+            void setTexture(const sf::Texture* texture);
+
+            // Adds a quad and returns its index.
+            std::size_t addQuad(const sf::FloatRect& rect, const sf::IntRect& textureRect, const sf::Color& color = sf::Color::White);
+
+            // Changes the texture rectangle of a quad, uploaded by the next update().
+            void setTextureRect(std::size_t quad, const sf::IntRect& textureRect);
+
+            // Uploads the whole buffer if quads were added, else the range of the quads changed.
+            void update();
+
+            // Removes all the quads.
+            void clear();
+
+            // Number of quads.
+            std::size_t getQuadCount() const;
+
+            // True if the quads are drawn from a vertex buffer.
+            bool isBuffered() const;
+
+        protected:
+            // Draws all the quads.
+            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+            const sf::Texture* m_texture;
+
+            // Vertices, in memory, and in the buffer once uploaded.
+            std::vector<sf::Vertex> m_vertices;
+            sf::VertexBuffer m_buffer;
+            bool m_buffered;
+
+            // Vertices in the buffer, and range of the ones changed since the last upload.
+            std::size_t m_uploaded;
+            std::size_t m_changedBegin, m_changedEnd;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_STATIC_GEOMETRY
@@ -0,0 +1,124 @@
+#include "SweptAabb.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace kantan
+{
+    namespace
+    {
+        // Values out of every step, for the axes without movement.
+        inline float lowestTime(float)
+        {
+            return -std::numeric_limits<float>::infinity();
+        }
+
+        inline float highestTime(float)
+        {
+            return std::numeric_limits<float>::infinity();
+        }
+
+        inline Fixed lowestTime(Fixed)
+        {
+            return Fixed::lowest();
+        }
+
+        inline Fixed highestTime(Fixed)
+        {
+            return Fixed::max();
+        }
+
+        inline float toTime(float time)
+        {
+            return time;
+        }
+
+        inline float toTime(Fixed time)
+        {
+            // The time is in [0, 1[, its 16 fractional bits fit in a float.
+            return time.toFloat();
+        }
+
+        // Computes when the interval [aMin, aMax] moving by d overlaps the interval [bMin, bMax].
+        // Returns false if they never do.
+        template<typename T>
+        bool sweepAxis(T aMin, T aMax, T bMin, T bMax, T d, T& entry, T& exit)
+        {
+            if(d > T(0))
+            {
+                entry = (bMin - aMax) / d;
+                exit = (bMax - aMin) / d;
+            }
+            else if(d < T(0))
+            {
+                entry = (bMax - aMin) / d;
+                exit = (bMin - aMax) / d;
+            }
+            else
+            {
+                // No movement on this axis: either they always overlap on it, or never.
+                if(!(aMin < bMax && bMin < aMax))
+                    return false;
+
+                entry = lowestTime(d);
+                exit = highestTime(d);
+            }
+
+            return true;
+        }
+
+        // Same test for both number types, over [0, limit[.
+        template<typename T>
+        bool sweep(const sf::Rect<T>& a, const sf::Vector2<T>& da, const sf::Rect<T>& b, const sf::Vector2<T>& db, T limit, SweepHit& hit)
+        {
+            // Work in b's frame: only a moves.
+            sf::Vector2<T> d = da - db;
+            T entryX, exitX, entryY, exitY;
+
+            if(!sweepAxis(std::min(a.left, a.left + a.width), std::max(a.left, a.left + a.width),
+                          std::min(b.left, b.left + b.width), std::max(b.left, b.left + b.width), d.x, entryX, exitX))
+                return false;
+
+            if(!sweepAxis(std::min(a.top, a.top + a.height), std::max(a.top, a.top + a.height),
+                          std::min(b.top, b.top + b.height), std::max(b.top, b.top + b.height), d.y, entryY, exitY))
+                return false;
+
+            // They overlap once they overlap on both axes, until they stop overlapping on one of them.
+            T entry = std::max(entryX, entryY);
+            T exit = std::min(exitX, exitY);
+
+            if(entry >= exit || entry >= limit || exit <= T(0))
+                return false;
+
+            if(entry < T(0))
+            {
+                hit.time = 0.f;
+                hit.axis = -1;
+            }
+            else
+            {
+                // The last axis to overlap is the one they met on, vertical first on a corner.
+                hit.time = toTime(entry);
+                hit.axis = entryY >= entryX ? 1 : 0;
+            }
+
+            return true;
+        }
+    }
+
+    /// Swept tests.
+    bool sweepAabb(const sf::FloatRect& a, const sf::Vector2f& da, const sf::FloatRect& b, const sf::Vector2f& db, SweepHit& hit)
+    {
+        return sweep(a, da, b, db, 1.f, hit);
+    }
+
+    bool sweepAabb(const FixedRect& a, const FixedVector2& da, const FixedRect& b, const FixedVector2& db, SweepHit& hit)
+    {
+        return sweep(a, da, b, db, Fixed(1), hit);
+    }
+
+    bool findTimeOfImpact(const sf::FloatRect& a, const sf::Vector2f& va, const sf::FloatRect& b, const sf::Vector2f& vb, float maxTime, SweepHit& hit)
+    {
+        return sweep(a, va, b, vb, maxTime, hit);
+    }
+} // namespace kantan.
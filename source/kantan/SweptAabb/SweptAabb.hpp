@@ -0,0 +1,41 @@
+#ifndef KANTAN_SWEPT_AABB
+#define KANTAN_SWEPT_AABB
+
+#include <SFML/Graphics.hpp>
+
+#include "../Fixed/Fixed.hpp"
+
+namespace kantan
+{
+    /**
+        SweepHit struct.
+        Result of a swept test: when the boxes start to overlap during the step, and on which axis they met.
+    **/
+    struct SweepHit
+    {
+        // Time of impact, in [0, 1] of the step.
+        float time;
+
+        // 0 for the x axis, 1 for the y axis, -1 if the boxes already overlapped at the start of the step.
+        int axis;
+    };
+
+    /**
+        sweepAabb function.
+        Moves the box a by da and the box b by db over the step, and returns true if they overlap at some point of it.
+        Touching edges do not count as an overlap, like in sf::FloatRect::intersects.
+    **/
+    bool sweepAabb(const sf::FloatRect& a, const sf::Vector2f& da, const sf::FloatRect& b, const sf::Vector2f& db, SweepHit& hit);
+
+    // Same test in fixed point, bit-exact on every machine. The time is a multiple of 1/65536, stored exactly in the float.
+    bool sweepAabb(const FixedRect& a, const FixedVector2& da, const FixedRect& b, const FixedVector2& db, SweepHit& hit);
+
+    /**
+        findTimeOfImpact function.
+        Same test for boxes moving at the constant velocities va and vb, over [0, maxTime[ (maxTime may be infinite).
+        The time is in the unit of the velocities.
+    **/
+    bool findTimeOfImpact(const sf::FloatRect& a, const sf::Vector2f& va, const sf::FloatRect& b, const sf::Vector2f& vb, float maxTime, SweepHit& hit);
+} // namespace kantan.
+
+#endif // KANTAN_SWEPT_AABB
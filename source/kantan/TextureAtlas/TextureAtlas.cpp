@@ -0,0 +1,163 @@
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace kantan
+{
+    /// Packing.
+    bool packRectangles(const std::vector<sf::Vector2u>& sizes, unsigned int maxSize, unsigned int padding,
+                        std::vector<sf::Vector2u>& positions, sf::Vector2u& size)
+    {
+        positions.assign(sizes.size(), sf::Vector2u(0, 0));
+        size = sf::Vector2u(0, 0);
+
+        if(sizes.empty())
+            return true;
+
+        // Tallest first, so each shelf wastes little height.
+        std::vector<std::size_t> order(sizes.size());
+        for(std::size_t i(0) ; i < order.size() ; ++i)
+            order[i] = i;
+
+        std::stable_sort(order.begin(), order.end(), [&sizes](std::size_t a, std::size_t b)
+        {
+            return sizes[a].y != sizes[b].y ? sizes[a].y > sizes[b].y : sizes[a].x > sizes[b].x;
+        });
+
+        unsigned int widest = 0;
+        for(const sf::Vector2u& s : sizes)
+            widest = std::max(widest, s.x + 2 * padding);
+
+        unsigned int width = 1;
+        while(width < widest)
+            width *= 2;
+
+        // Narrowest width whose height is not bigger, else the narrowest that fits at all.
+        bool found = false;
+        std::vector<sf::Vector2u> candidate(sizes.size());
+
+        for( ; width <= maxSize ; width *= 2)
+        {
+            unsigned int x = 0, y = 0, shelf = 0;
+
+            for(std::size_t index : order)
+            {
+                const unsigned int w = sizes[index].x + 2 * padding, h = sizes[index].y + 2 * padding;
+
+                // Next shelf.
+                if(x + w > width)
+                {
+                    y += shelf;
+                    x = shelf = 0;
+                }
+
+                candidate[index] = sf::Vector2u(x + padding, y + padding);
+                x += w;
+                shelf = std::max(shelf, h);
+            }
+
+            const unsigned int height = y + shelf;
+            if(height > maxSize)
+                continue;
+
+            if(!found || height <= width)
+            {
+                positions = candidate;
+                size = sf::Vector2u(width, height);
+                found = true;
+            }
+
+            if(height <= width)
+                break;
+        }
+
+        return found;
+    }
+
+    /// Ctor.
+    TextureAtlas::TextureAtlas(unsigned int padding)
+        : m_padding(padding)
+    {}
+
+    /// Images.
+    void TextureAtlas::load(unsigned int id, const std::string& filename)
+    {
+        sf::Image image;
+        if(!image.loadFromFile(filename))
+            throw std::runtime_error("TextureAtlas::load - Failed to load " + filename);
+
+        add(id, image);
+    }
+
+    void TextureAtlas::add(unsigned int id, const sf::Image& image)
+    {
+        m_images[id] = image;
+    }
+
+    void TextureAtlas::build()
+    {
+        std::vector<sf::Vector2u> sizes, positions;
+        for(const auto& image : m_images)
+            sizes.push_back(image.second.getSize());
+
+        sf::Vector2u size;
+        if(!packRectangles(sizes, sf::Texture::getMaximumSize(), m_padding, positions, size))
+            throw std::runtime_error("TextureAtlas::build - The images do not fit in one texture");
+
+        // Copy the images in place, the padding stays transparent.
+        sf::Image atlas;
+        atlas.create(std::max(size.x, 1u), std::max(size.y, 1u), sf::Color::Transparent);
+
+        m_rects.clear();
+        std::size_t i = 0;
+
+        for(const auto& image : m_images)
+        {
+            atlas.copy(image.second, positions[i].x, positions[i].y);
+            m_rects[image.first] = sf::IntRect(positions[i].x, positions[i].y, image.second.getSize().x, image.second.getSize().y);
+            ++i;
+        }
+
+        m_images.clear();
+
+        if(!m_texture.loadFromImage(atlas))
+            throw std::runtime_error("TextureAtlas::build - Failed to create the texture");
+    }
+
+    /// Getters.
+    const sf::Texture& TextureAtlas::getTexture() const
+    {
+        return m_texture;
+    }
+
+    sf::IntRect TextureAtlas::getRect(unsigned int id) const
+    {
+        auto found = m_rects.find(id);
+
+        if(found == m_rects.end())
+            throw std::runtime_error("TextureAtlas::getRect - No image " + std::to_string(id) + " in the atlas");
+
+        return found->second;
+    }
+
+    sf::IntRect TextureAtlas::map(unsigned int id, const sf::IntRect& rect) const
+    {
+        sf::IntRect image = getRect(id);
+        return sf::IntRect(image.left + rect.left, image.top + rect.top, rect.width, rect.height);
+    }
+
+    /// Sprites.
+    void TextureAtlas::apply(sf::Sprite& sprite, unsigned int id) const
+    {
+        sprite.setTexture(m_texture);
+        sprite.setTextureRect(getRect(id));
+    }
+
+    void TextureAtlas::apply(sf::Sprite& sprite, unsigned int id, const sf::IntRect& rect) const
+    {
+        sprite.setTexture(m_texture);
+        sprite.setTextureRect(map(id, rect));
+    }
+} // namespace kantan.
@@ -0,0 +1,64 @@
+#ifndef KANTAN_TEXTURE_ATLAS
+#define KANTAN_TEXTURE_ATLAS
+
+#include <SFML/Graphics.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kantan
+{
+    // Packs rectangles of the given sizes in shelves, the tallest first, in the narrowest power of two width
+    // that gives a square-ish result, with padding pixels around each one. Fills their positions and the size used.
+    // Returns false if they do not fit in maxSize x maxSize.
+    bool packRectangles(const std::vector<sf::Vector2u>& sizes, unsigned int maxSize, unsigned int padding,
+                        std::vector<sf::Vector2u>& positions, sf::Vector2u& size);
+
+    /**
+        TextureAtlas class.
+        Packs several images in one texture, so the sprites using them can be drawn in one call.
+        The images are added by id, then build() packs them; the rectangles of the sprites are then mapped in the atlas.
+    **/
+    class TextureAtlas
+    {
+        public:
+            // Ctor.
+            explicit TextureAtlas(unsigned int padding = 1);
+
+            // Adds an image under an id, loaded from a file (throws if it cannot be loaded).
+            void load(unsigned int id, const std::string& filename);
+
+            // Adds an image under an id.
+            void add(unsigned int id, const sf::Image& image);
+
+            // Packs the images added and creates the texture (throws if they do not fit in the biggest texture).
+            void build();
+
+            // Atlas texture.
+            const sf::Texture& getTexture() const;
+
+            // Rectangle of an image in the atlas, throws if it is not there.
+            sf::IntRect getRect(unsigned int id) const;
+
+            // Maps a rectangle of an image into the atlas.
+            sf::IntRect map(unsigned int id, const sf::IntRect& rect) const;
+
+            // Sets the atlas texture on a sprite, with the given rectangle of an image (the whole image by default).
+            void apply(sf::Sprite& sprite, unsigned int id) const;
+            void apply(sf::Sprite& sprite, unsigned int id, const sf::IntRect& rect) const;
+
+        protected:
+            unsigned int m_padding;
+
+            // Images waiting for build().
+            std::map<unsigned int, sf::Image> m_images;
+
+            // Rectangles of the images in the texture.
+            std::map<unsigned int, sf::IntRect> m_rects;
+
+            sf::Texture m_texture;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_TEXTURE_ATLAS
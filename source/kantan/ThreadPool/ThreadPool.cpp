@@ -0,0 +1,119 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace kantan
+{
+    /// Ctor.
+    ThreadPool::ThreadPool(unsigned int threadCount)
+        : m_task(nullptr)
+        , m_count(0)
+        , m_batchSize(1)
+        , m_nextBatch(0)
+        , m_busy(0)
+        , m_generation(0)
+        , m_stop(false)
+    {
+        if(threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        // The calling thread is the first worker.
+        for(unsigned int worker(1) ; worker < threadCount ; ++worker)
+            m_threads.push_back(std::thread(&ThreadPool::work, this, worker));
+    }
+
+    /// Dtor.
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_wake.notify_all();
+
+        for(std::thread& thread : m_threads)
+            thread.join();
+    }
+
+    /// Threads.
+    unsigned int ThreadPool::getThreadCount() const
+    {
+        return static_cast<unsigned int>(m_threads.size()) + 1;
+    }
+
+    /// Loops.
+    void ThreadPool::parallelFor(std::size_t count, std::size_t batchSize, const Task& task)
+    {
+        if(count == 0)
+            return;
+
+        batchSize = std::max<std::size_t>(1, batchSize);
+
+        // Not worth waking anybody.
+        if(m_threads.empty() || count <= batchSize)
+        {
+            for(std::size_t begin(0) ; begin < count ; begin += batchSize)
+                task(begin, std::min(count, begin + batchSize), 0);
+
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_count = count;
+            m_batchSize = batchSize;
+            m_nextBatch = 0;
+            m_busy = static_cast<unsigned int>(m_threads.size());
+            ++m_generation;
+        }
+
+        m_wake.notify_all();
+        runBatches(0);
+
+        // Wait for the others.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this]{ return m_busy == 0; });
+        m_task = nullptr;
+    }
+
+    void ThreadPool::runBatches(unsigned int worker)
+    {
+        for(;;)
+        {
+            std::size_t begin = m_nextBatch.fetch_add(1) * m_batchSize;
+
+            if(begin >= m_count)
+                break;
+
+            (*m_task)(begin, std::min(m_count, begin + m_batchSize), worker);
+        }
+    }
+
+    void ThreadPool::work(unsigned int worker)
+    {
+        unsigned long generation = 0;
+
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this, generation]{ return m_stop || m_generation != generation; });
+
+                if(m_stop)
+                    return;
+
+                generation = m_generation;
+            }
+
+            runBatches(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(--m_busy == 0)
+                    m_done.notify_one();
+            }
+        }
+    }
+} // namespace kantan.
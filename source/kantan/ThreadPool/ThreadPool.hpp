@@ -0,0 +1,59 @@
+#ifndef KANTAN_THREAD_POOL
+#define KANTAN_THREAD_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kantan
+{
+    /**
+        ThreadPool class.
+        Runs a loop over [0, count[ in fixed-size batches, shared between the worker threads and the calling thread.
+        The calling thread is the worker 0, so a pool of one thread simply runs the loop in place.
+        parallelFor must not be called from inside a task.
+    **/
+    class ThreadPool
+    {
+        public:
+            // Task run on the batch [begin, end[ by the given worker.
+            typedef std::function<void(std::size_t begin, std::size_t end, unsigned int worker)> Task;
+
+            // Ctor, 0 threads means one per hardware thread.
+            explicit ThreadPool(unsigned int threadCount = 0);
+
+            // Dtor.
+            ~ThreadPool();
+
+            // Number of threads, the calling one included.
+            unsigned int getThreadCount() const;
+
+            // Runs the task on all the batches and returns when they are all done.
+            void parallelFor(std::size_t count, std::size_t batchSize, const Task& task);
+
+        protected:
+            // Worker threads loop.
+            void work(unsigned int worker);
+
+            // Takes batches until there is no more.
+            void runBatches(unsigned int worker);
+
+            std::vector<std::thread> m_threads;
+
+            // Current job.
+            std::mutex m_mutex;
+            std::condition_variable m_wake, m_done;
+            const Task* m_task;
+            std::size_t m_count, m_batchSize;
+            std::atomic<std::size_t> m_nextBatch;
+            unsigned int m_busy;
+            unsigned long m_generation;
+            bool m_stop;
+    };
+} // namespace kantan.
+
+#endif // KANTAN_THREAD_POOL
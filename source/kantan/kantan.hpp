@@ -8,4 +8,26 @@
 #include "Event/Event.hpp"
 #include "ResourceHolder/ResourceHolder.hpp"
 
+#include "AabbKernel/AabbKernel.hpp"
+#include "Fixed/Fixed.hpp"
+#include "SweptAabb/SweptAabb.hpp"
+#include "FixedTimestep/FixedTimestep.hpp"
+#include "CollisionMatrix/CollisionMatrix.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include "ContactCache/ContactCache.hpp"
+#include "SpatialGrid/SpatialGrid.hpp"
+#include "ImpactScheduler/ImpactScheduler.hpp"
+#include "ProjectileBatch/ProjectileBatch.hpp"
+#include "MortonOrder/MortonOrder.hpp"
+#include "ParticleEngine/ParticleEngine.hpp"
+#include "ParticleBudget/ParticleBudget.hpp"
+#include "TextureAtlas/TextureAtlas.hpp"
+#include "RenderQueue/RenderQueue.hpp"
+#include "CommandBuffer/CommandBuffer.hpp"
+#include "RenderBackend/RenderBackend.hpp"
+#include "StaticGeometry/StaticGeometry.hpp"
+#include "HudLayer/HudLayer.hpp"
+#include "GlyphCache/GlyphCache.hpp"
+#include "CollisionResponseRegistry/CollisionResponseRegistry.hpp"
+
 #endif // KANTAN
@@ -7,12 +7,31 @@
 #include <string>
 #include <sstream>
 #include <utility>
+#include <stdexcept>
+#include <iostream>
 
+#include <algorithm>
+#include <functional>
 #include <cstdlib>
 #include <cmath>
 
 enum Difficulty {EASY, NORMAL, HARD, JAPANESE};
 
+/**
+    Collision layers.
+**/
+enum CollisionLayer {PlayerLayer = 0, BallLayer, SakuraLayer, WallLayer};
+
+/**
+    Projectile paths: swept each step like any body, impacts scheduled ahead of time, or packed vertical projectiles.
+**/
+enum ProjectilePath {SweptProjectiles = 0, ScheduledProjectiles, PackedProjectiles};
+
+/**
+    Draw layers of the sprites, from the bottom one to the top one.
+**/
+enum DrawLayer {ParticleDrawLayer = 0, WallDrawLayer, PlayerDrawLayer, ProjectileDrawLayer, HudDrawLayer};
+
 /**
     Constants.
 **/
@@ -25,6 +44,18 @@ float BALLS_INTERVAL = 750.f;
 float PLAYER_SPEED = 500.f;
 float SHOOT_INTERVAL = 250.f;
 float AFFINITY_CHANGE_INTERVAL = 25;
+unsigned int TICK_RATE = 120;
+unsigned int MAX_CATCH_UP_STEPS = 8;
+unsigned int WORKER_THREADS = 0;
+bool FIXED_POINT_PHYSICS = false;
+ProjectilePath PROJECTILE_PATH = SweptProjectiles;
+bool MORTON_REORDER = false;
+std::size_t PARTICLE_CAPACITY = 65536;
+std::size_t MENU_PARTICLE_CAPACITY = 4096;
+std::size_t PARTICLE_BUDGET = 24000;
+float FRAME_BUDGET = 1000.f / 60.f;
+unsigned int MORTON_BUDGET = 512;
+std::string CAPTURE_FILE = "frame.kcb";
 
 /**
     Helpers.
@@ -98,10 +129,30 @@ class HitboxComponent : public kantan::Component
         HitboxComponent()
             : kantan::Component(std::string("Hitbox"))
             , isBlocking(true)
+            , layers(~0u)
+            , mask(~0u)
+            , hasPreviousPosition(false)
+            , hasFixedPosition(false)
+            , isKinematic(false)
         {}
 
         sf::FloatRect hitbox;
         bool isBlocking;
+
+        // Collision layers the hitbox is on, and the ones it collides with (all of them by default).
+        unsigned int layers;
+        unsigned int mask;
+
+        // Position at the start of the last step, to interpolate the rendering.
+        sf::Vector2f previousPosition;
+        bool hasPreviousPosition;
+
+        // Exact position in fixed-point physics, hitbox holds its rounding (taken back from hitbox if it is moved).
+        kantan::FixedVector2 fixedPosition;
+        bool hasFixedPosition;
+
+        // Moves at a constant velocity and never blocks: its impacts can be computed once instead of being searched each step.
+        bool isKinematic;
 };
 
 /*
@@ -110,10 +161,44 @@ class HitboxComponent : public kantan::Component
 class SpriteComponent : public kantan::Component
 {
     public:
-        SpriteComponent() : kantan::Component(std::string("Sprite"))
+        SpriteComponent()
+            : kantan::Component(std::string("Sprite"))
+            , layer(WallDrawLayer)
         {}
 
         sf::Sprite sprite;
+
+        // Draw layer, the sprites of a higher layer are drawn over.
+        int layer;
+};
+
+/*
+    Static quad component.
+*/
+class StaticQuadComponent : public kantan::Component
+{
+    public:
+        StaticQuadComponent()
+            : kantan::Component(std::string("StaticQuad"))
+            , geometry(nullptr)
+            , quad(0)
+        {}
+
+        // Geometry the quad is baked in, and its index there.
+        kantan::StaticGeometry* geometry;
+        std::size_t quad;
+};
+
+/*
+    Color component.
+*/
+class ColorComponent : public kantan::Component
+{
+    public:
+        ColorComponent() : kantan::Component(std::string("Color"))
+        {}
+
+        sf::Color color;
 };
 
 /*
@@ -124,9 +209,14 @@ class MovementComponent : public kantan::Component
     public:
         MovementComponent()
             : kantan::Component(std::string("Movement"))
+            , hasFixedVelocity(false)
         {}
 
         sf::Vector2f velocity;
+
+        // Exact velocity in fixed-point physics, velocity holds its rounding (taken back from velocity if it is changed).
+        kantan::FixedVector2 fixedVelocity;
+        bool hasFixedVelocity;
 };
 
 /*
@@ -170,285 +260,927 @@ class LifeComponent : public kantan::Component
         bool alive;
 };
 
+/**
+    Systems.
+**/
 /*
-    Particle component.
+    Physic collision & response system.
 */
-class ParticleComponent : public kantan::Component
+class PhysicSystem : public kantan::System
 {
     public:
-        ParticleComponent()
-            : kantan::Component(std::string("Particle"))
-            , m_particles(1000)
-            , m_vertices(sf::Points, 1000)
+        PhysicSystem()
+            : m_fixedPoint(false)
+            , m_threads(nullptr)
+            , m_projectilePath(SweptProjectiles)
+            , m_step(0)
         {}
 
-        void init()
+        // Sets the threads the narrow phase is spread on (none by default).
+        void setThreadPool(kantan::ThreadPool* threads)
+        {
+            m_threads = threads;
+        }
+
+        // Runs the integration and the narrow phase in Q16.16 fixed point (off by default), for a simulation
+        // that is bit-exact on every machine. The broadphase stays in float, with a margin.
+        void setFixedPoint(bool fixedPoint)
+        {
+            m_fixedPoint = fixedPoint;
+        }
+
+        bool isFixedPoint() const
+        {
+            return m_fixedPoint;
+        }
+
+        // Chooses how the kinematic hitboxes are handled (swept like the others by default). Not used in fixed point.
+        // Scheduled: their impacts are computed when they appear, and again only when one of the two bodies changes.
+        // Packed: the vertical ones are tested in a projectile batch, on the y axis only.
+        void setProjectilePath(ProjectilePath path)
+        {
+            m_projectilePath = path;
+
+            m_impacts.clear();
+            m_touching.clear();
+            m_kinematics.clear();
+            m_targets.clear();
+            m_projectiles.clear();
+        }
+
+        ProjectilePath getProjectilePath() const
+        {
+            return m_projectilePath;
+        }
+
+        // Update.
+        virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
+        {
+            m_contactCache.beginStep();
+
+            gather(entities);
+            integrate(elapsed);
+            findPairs();
+            findContacts();
+            resolve(elapsed);
+            scheduleImpacts(elapsed);
+            stepProjectiles(elapsed);
+            buildIndex();
+
+            m_contactCache.endStep();
+        }
+
+        // Returns the contacts of the last step: the ones that began, persisted or ended, in the order they happened.
+        const kantan::ContactCache& getContacts() const
+        {
+            return m_contactCache;
+        }
+
+        // Returns the hitboxes at the end of the last step, for region, ray and nearest entities queries.
+        const kantan::SpatialGrid& getSpatialIndex() const
+        {
+            return m_spatialIndex;
+        }
+
+        // Removes an entity destroyed since the last step from the index.
+        void forget(kantan::Entity* entity)
+        {
+            m_spatialIndex.remove(entity);
+        }
+
+    protected:
+        // A collision found during the step, between two bodies.
+        struct Contact
+        {
+            float time;
+            int axis;
+            unsigned int first, second;
+        };
+
+        // Two bodies that may collide.
+        struct Pair
+        {
+            unsigned int first, second;
+        };
+
+        // Number of pairs a thread takes at once.
+        static const std::size_t NarrowPhaseBatch = 64;
+
+        // A kinematic body: where and when its current motion started, and where the last step left it.
+        struct Kinematic
+        {
+            kantan::Entity* entity;
+            HitboxComponent* hitbox;
+            sf::Vector2f origin, velocity, position;
+            sf::Time start;
+
+            // Last steps it was seen, and its impacts scheduled.
+            unsigned int seen, scheduled;
+        };
+
+        // Any other body, as its kinematic impacts were computed.
+        struct Target
+        {
+            sf::FloatRect box;
+            unsigned int seen;
+        };
+
+        // Impacts further than this (in seconds) are never scheduled.
+        static constexpr float ImpactHorizon = 3600.f;
+
+        // Growth of the swept boxes in fixed point. The float boxes are roundings of the fixed ones
+        // (at most 1/1024 px off on the screen), so the broadphase still finds every pair the fixed test can hit.
+        static constexpr float FixedBroadphaseMargin = 1.f / 256.f;
+
+        // Copies the hitboxes, and the movers' positions & velocities in contiguous arrays.
+        void gather(std::vector<kantan::Entity*>& entities)
         {
-            for(std::size_t i(0) ; i < m_particles.size() ; ++i)
+            m_bodies.clear();
+            m_hitboxes.clear();
+            m_moverOf.clear();
+
+            m_movers.clear();
+            m_positionX.clear();
+            m_positionY.clear();
+            m_velocityX.clear();
+            m_velocityY.clear();
+
+            m_kinematicBodies.clear();
+
+            m_fixedBoxes.clear();
+            m_fixedPositionX.clear();
+            m_fixedPositionY.clear();
+            m_fixedVelocityX.clear();
+            m_fixedVelocityY.clear();
+
+            for(kantan::Entity* e : entities)
             {
-                m_vertices[i].color = color;
-                m_vertices[i].position = center;
+                // If the entity has no hitbox, there cannot be a collision.
+                if(!e->hasComponent("Hitbox"))
+                    continue;
+
+                HitboxComponent* hitbox = e->getComponent<HitboxComponent>("Hitbox");
+
+                // Keep where it was for the rendering interpolation.
+                hitbox->previousPosition = sf::Vector2f(hitbox->hitbox.left, hitbox->hitbox.top);
+                hitbox->hasPreviousPosition = true;
+
+                // Kinematic bodies have their own path (only vertical ones for the packed one).
+                if(m_projectilePath != SweptProjectiles && !m_fixedPoint && hitbox->isKinematic && e->hasComponent("Movement")
+                   && (m_projectilePath != PackedProjectiles || e->getComponent<MovementComponent>("Movement")->velocity.x == 0.f))
+                {
+                    m_kinematicBodies.push_back(e);
+                    continue;
+                }
+
+                if(m_fixedPoint)
+                {
+                    // The game moved the hitbox itself.
+                    if(!hitbox->hasFixedPosition || hitbox->fixedPosition.x.toFloat() != hitbox->hitbox.left || hitbox->fixedPosition.y.toFloat() != hitbox->hitbox.top)
+                    {
+                        hitbox->fixedPosition = kantan::FixedVector2(kantan::Fixed::fromFloat(hitbox->hitbox.left), kantan::Fixed::fromFloat(hitbox->hitbox.top));
+                        hitbox->hasFixedPosition = true;
+                    }
+
+                    m_fixedBoxes.push_back(kantan::FixedRect(hitbox->fixedPosition, kantan::FixedVector2(kantan::Fixed::fromFloat(hitbox->hitbox.width), kantan::Fixed::fromFloat(hitbox->hitbox.height))));
+                }
+
+                // Entities with a movement are the ones to modify.
+                if(e->hasComponent("Movement"))
+                {
+                    MovementComponent* movement = e->getComponent<MovementComponent>("Movement");
+
+                    m_moverOf.push_back(static_cast<int>(m_movers.size()));
+                    m_movers.push_back(static_cast<unsigned int>(m_bodies.size()));
+                    m_positionX.push_back(hitbox->hitbox.left);
+                    m_positionY.push_back(hitbox->hitbox.top);
+                    m_velocityX.push_back(movement->velocity.x);
+                    m_velocityY.push_back(movement->velocity.y);
+
+                    if(m_fixedPoint)
+                    {
+                        // The game changed the velocity itself.
+                        if(!movement->hasFixedVelocity || movement->fixedVelocity.x.toFloat() != movement->velocity.x || movement->fixedVelocity.y.toFloat() != movement->velocity.y)
+                        {
+                            movement->fixedVelocity = kantan::FixedVector2(kantan::Fixed::fromFloat(movement->velocity.x), kantan::Fixed::fromFloat(movement->velocity.y));
+                            movement->hasFixedVelocity = true;
+                        }
+
+                        m_fixedPositionX.push_back(hitbox->fixedPosition.x);
+                        m_fixedPositionY.push_back(hitbox->fixedPosition.y);
+                        m_fixedVelocityX.push_back(movement->fixedVelocity.x);
+                        m_fixedVelocityY.push_back(movement->fixedVelocity.y);
+                    }
+                }
+                else
+                    m_moverOf.push_back(-1);
+
+                m_bodies.push_back(e);
+                m_hitboxes.push_back(hitbox);
             }
         }
 
-        sf::Color color;
-        sf::Vector2f center;
+        // Computes the proposed movement of every mover, in one pass the compiler can vectorize.
+        void integrate(sf::Time elapsed)
+        {
+            const std::size_t n = m_movers.size();
+
+            m_movementX.resize(n);
+            m_movementY.resize(n);
+            m_corrected.assign(n, false);
+
+            float* movementX = m_movementX.data();
+            float* movementY = m_movementY.data();
+
+            if(m_fixedPoint)
+            {
+                // The step comes from the integer microseconds of the time, not from a float.
+                const kantan::Fixed dt = kantan::Fixed::fromTime(elapsed);
+
+                m_fixedMovementX.resize(n);
+                m_fixedMovementY.resize(n);
+
+                const kantan::Fixed* velocityX = m_fixedVelocityX.data();
+                const kantan::Fixed* velocityY = m_fixedVelocityY.data();
+                kantan::Fixed* fixedMovementX = m_fixedMovementX.data();
+                kantan::Fixed* fixedMovementY = m_fixedMovementY.data();
+
+                for(std::size_t i(0) ; i < n ; ++i)
+                {
+                    fixedMovementX[i] = velocityX[i] * dt;
+                    fixedMovementY[i] = velocityY[i] * dt;
+
+                    // Rounded copy for the broadphase.
+                    movementX[i] = fixedMovementX[i].toFloat();
+                    movementY[i] = fixedMovementY[i].toFloat();
+                }
+
+                return;
+            }
+
+            const float dt = elapsed.asSeconds();
+            const float* velocityX = m_velocityX.data();
+            const float* velocityY = m_velocityY.data();
+
+            for(std::size_t i(0) ; i < n ; ++i)
+            {
+                movementX[i] = velocityX[i] * dt;
+                movementY[i] = velocityY[i] * dt;
+            }
+        }
 
-        struct Particle
+        // Returns the movement of a body during the step.
+        sf::Vector2f getMovement(unsigned int body) const
         {
-            Particle()
-                : lifetime(sf::seconds(1.f))
+            int mover = m_moverOf[body];
+
+            if(mover < 0)
+                return sf::Vector2f(0.f, 0.f);
+
+            return sf::Vector2f(m_movementX[mover], m_movementY[mover]);
+        }
+
+        kantan::FixedVector2 getFixedMovement(unsigned int body) const
+        {
+            int mover = m_moverOf[body];
+
+            if(mover < 0)
+                return kantan::FixedVector2();
+
+            return kantan::FixedVector2(m_fixedMovementX[mover], m_fixedMovementY[mover]);
+        }
+
+        // Swept test of two bodies, in fixed point if it is enabled.
+        bool sweepPair(unsigned int first, unsigned int second, kantan::SweepHit& hit) const
+        {
+            if(m_fixedPoint)
+                return kantan::sweepAabb(m_fixedBoxes[first], getFixedMovement(first), m_fixedBoxes[second], getFixedMovement(second), hit);
+
+            return kantan::sweepAabb(m_hitboxes[first]->hitbox, getMovement(first), m_hitboxes[second]->hitbox, getMovement(second), hit);
+        }
+
+        // Stops the movement of a mover on an axis, at the given time of the step.
+        void stopMovement(int mover, int axis, float time)
+        {
+            if(m_fixedPoint)
             {
-                float angle = (std::rand() % 360) * 3.14f / 180.f;
-                float speed = (std::rand() % 50) + 20.f;
-                velocity = sf::Vector2f(std::cos(angle) * speed, std::sin(angle) * speed);
-                lifetime = sf::milliseconds((std::rand() % 2000) + 1000);
+                // The time is a fixed-point value, the conversion back is exact.
+                kantan::Fixed& movement = axis == 0 ? m_fixedMovementX[mover] : m_fixedMovementY[mover];
+                movement *= kantan::Fixed::fromFloat(time);
+
+                (axis == 0 ? m_movementX[mover] : m_movementY[mover]) = movement.toFloat();
             }
+            else if(axis == 0)
+                m_movementX[mover] *= time;
+            else
+                m_movementY[mover] *= time;
+        }
 
-            sf::Vector2f velocity;
-            sf::Time lifetime;
-        };
+        // Broadphase: finds the pairs of bodies whose movements cross.
+        void findPairs()
+        {
+            m_pairs.clear();
 
-        std::vector<Particle> m_particles;
-        sf::VertexArray m_vertices;
-        sf::Time lifetime;
-};
+            // Bound the whole movement of each body, so fast bodies cannot go through thin ones.
+            m_sweeps.clear();
+            for(unsigned int body(0) ; body < m_bodies.size() ; ++body)
+            {
+                sf::FloatRect swept = m_hitboxes[body]->hitbox;
+                sf::Vector2f movement = getMovement(body);
 
-/**
-    Systems.
-**/
-/*
-    Physic collision & response system.
-*/
-class PhysicSystem : public kantan::System
-{
-    public:
-        PhysicSystem(){}
+                swept.left += std::min(0.f, movement.x);
+                swept.top += std::min(0.f, movement.y);
+                swept.width += std::abs(movement.x);
+                swept.height += std::abs(movement.y);
 
-        // Update.
-        virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
+                if(m_fixedPoint)
+                {
+                    swept.left -= FixedBroadphaseMargin;
+                    swept.top -= FixedBroadphaseMargin;
+                    swept.width += 2.f * FixedBroadphaseMargin;
+                    swept.height += 2.f * FixedBroadphaseMargin;
+                }
+
+                m_sweeps.push(swept, m_hitboxes[body]->layers);
+            }
+
+            for(std::size_t mover(0) ; mover < m_movers.size() ; ++mover)
+            {
+                unsigned int fst = m_movers[mover];
+
+                // The kernel skips the hitboxes on layers fst does not collide with.
+                m_candidates.clear();
+                m_kernel.findIntersections(sf::FloatRect(m_sweeps.minX[fst], m_sweeps.minY[fst], m_sweeps.maxX[fst] - m_sweeps.minX[fst], m_sweeps.maxY[fst] - m_sweeps.minY[fst]), m_sweeps, m_candidates, m_hitboxes[fst]->mask);
+
+                for(unsigned int snd : m_candidates)
+                {
+                    // Do not check against yourself, and check two movers only once.
+                    if(snd == fst || (m_moverOf[snd] >= 0 && m_moverOf[snd] < static_cast<int>(mover)))
+                        continue;
+
+                    // Both must want the collision.
+                    if(!kantan::CollisionMatrix::canCollide(m_hitboxes[fst]->layers, m_hitboxes[fst]->mask, m_hitboxes[snd]->layers, m_hitboxes[snd]->mask))
+                        continue;
+
+                    m_pairs.push_back(Pair{fst, snd});
+                }
+            }
+        }
+
+        // Narrow phase: finds when each pair collides, if it does.
+        void findContacts()
         {
-            m_collisions.clear();
+            unsigned int threadCount = m_threads ? m_threads->getThreadCount() : 1;
+            m_threadContacts.resize(threadCount);
 
-            // We check each entities against all the overs.
-            // It's a naive and slow way of doing it.
-            for(kantan::Entity* fst : entities)
+            for(std::vector<Contact>& contacts : m_threadContacts)
+                contacts.clear();
+
+            auto sweep = [this](std::size_t begin, std::size_t end, unsigned int worker)
             {
-                // If one the entities has no hitbox, there cannot be a collision.
-                // If this entity has no movement, it's not the one to modify.
-                if(!fst->hasComponent("Hitbox") || !fst->hasComponent("Movement"))
-                    continue;
+                // Each thread has its own buffer, nothing is shared.
+                std::vector<Contact>& contacts = m_threadContacts[worker];
 
-                // We get the fst's hitbox & fst's movement.
-                HitboxComponent* fstHitbox = fst->getComponent<HitboxComponent>("Hitbox");
-                MovementComponent* fstMovement = fst->getComponent<MovementComponent>("Movement");
+                for(std::size_t i(begin) ; i < end ; ++i)
+                {
+                    const Pair& pair = m_pairs[i];
+
+                    kantan::SweepHit hit;
+                    if(sweepPair(pair.first, pair.second, hit))
+                        contacts.push_back(Contact{hit.time, hit.axis, pair.first, pair.second});
+                }
+            };
 
-                for(kantan::Entity* snd : entities)
+            if(m_threads)
+                m_threads->parallelFor(m_pairs.size(), NarrowPhaseBatch, sweep);
+            else
+                sweep(0, m_pairs.size(), 0);
+
+            // Merge.
+            m_contacts.clear();
+            for(const std::vector<Contact>& contacts : m_threadContacts)
+                m_contacts.insert(m_contacts.end(), contacts.begin(), contacts.end());
+
+            // Handle them in the order they happened. A pair appears once, so the order is total
+            // and the result does not depend on which thread found what.
+            std::sort(m_contacts.begin(), m_contacts.end(), [](const Contact& l, const Contact& r)
+            {
+                if(l.time != r.time)
+                    return l.time < r.time;
+                if(l.first != r.first)
+                    return l.first < r.first;
+                return l.second < r.second;
+            });
+        }
+
+        // Records the contacts and stops the movements of the blocking ones.
+        void resolve(sf::Time elapsed)
+        {
+            for(Contact contact : m_contacts)
+            {
+                int fstMover = m_moverOf[contact.first];
+                int sndMover = m_moverOf[contact.second];
+
+                // A movement stopped earlier in the step may avoid this contact now.
+                if(m_corrected[fstMover] || (sndMover >= 0 && m_corrected[sndMover]))
                 {
-                    // Do not check against yourself.
-                    if(fst == snd)
+                    kantan::SweepHit hit;
+                    if(!sweepPair(contact.first, contact.second, hit))
                         continue;
 
-                    // If one the entities has no hitbox, there cannot be a collision.
-                    if(!snd->hasComponent("Hitbox"))
-                        continue;
+                    contact.time = hit.time;
+                    contact.axis = hit.axis;
+                }
+
+                // If both hitboxes are blocking, the movements stop where they met (an intern collision is left as it is).
+                if(m_hitboxes[contact.first]->isBlocking && m_hitboxes[contact.second]->isBlocking && contact.axis >= 0)
+                {
+                    stopMovement(fstMover, contact.axis, contact.time);
+                    m_corrected[fstMover] = true;
+
+                    // Two movers: the snd one would pass through the fst one otherwise.
+                    if(sndMover >= 0)
+                    {
+                        stopMovement(sndMover, contact.axis, contact.time);
+                        m_corrected[sndMover] = true;
+                    }
+                }
+
+                // Record the collision.
+                m_contactCache.add(m_bodies[contact.first], m_bodies[contact.second]);
+            }
+
+            if(m_fixedPoint)
+            {
+                applyFixed(elapsed);
+                return;
+            }
+
+            const float dt = elapsed.asSeconds();
+
+            // Now we apply the corrected movements to the hitboxes.
+            for(std::size_t mover(0) ; mover < m_movers.size() ; ++mover)
+            {
+                unsigned int body = m_movers[mover];
+
+                m_hitboxes[body]->hitbox.left = m_positionX[mover] + m_movementX[mover];
+                m_hitboxes[body]->hitbox.top = m_positionY[mover] + m_movementY[mover];
+
+                // The velocity reflects the corrected movement.
+                if(m_corrected[mover] && dt > 0.f)
+                {
+                    MovementComponent* movement = m_bodies[body]->getComponent<MovementComponent>("Movement");
+                    movement->velocity = sf::Vector2f(m_movementX[mover], m_movementY[mover]) / dt;
+                }
+            }
+        }
+
+        // Applies the corrected movements in fixed point, the floats get their rounding.
+        void applyFixed(sf::Time elapsed)
+        {
+            const kantan::Fixed dt = kantan::Fixed::fromTime(elapsed);
+
+            for(std::size_t mover(0) ; mover < m_movers.size() ; ++mover)
+            {
+                HitboxComponent* hitbox = m_hitboxes[m_movers[mover]];
+
+                hitbox->fixedPosition = kantan::FixedVector2(m_fixedPositionX[mover] + m_fixedMovementX[mover], m_fixedPositionY[mover] + m_fixedMovementY[mover]);
+                hitbox->hitbox.left = hitbox->fixedPosition.x.toFloat();
+                hitbox->hitbox.top = hitbox->fixedPosition.y.toFloat();
+
+                // The velocity reflects the corrected movement.
+                if(m_corrected[mover] && dt > kantan::Fixed(0))
+                {
+                    MovementComponent* movement = m_bodies[m_movers[mover]]->getComponent<MovementComponent>("Movement");
+                    movement->fixedVelocity = kantan::FixedVector2(m_fixedMovementX[mover] / dt, m_fixedMovementY[mover] / dt);
+                    movement->velocity = sf::Vector2f(movement->fixedVelocity.x.toFloat(), movement->fixedVelocity.y.toFloat());
+                }
+            }
+        }
+
+        // Moves the kinematic bodies, updates their scheduled impacts and records the ones that happened during the step.
+        void scheduleImpacts(sf::Time elapsed)
+        {
+            if(m_projectilePath != ScheduledProjectiles)
+                return;
+
+            m_time += elapsed;
+            ++m_step;
+
+            // Kinematic bodies that appeared, or whose velocity or position the game changed, start a new motion.
+            m_started.clear();
+            for(kantan::Entity* e : m_kinematicBodies)
+            {
+                HitboxComponent* hitbox = e->getComponent<HitboxComponent>("Hitbox");
+                MovementComponent* movement = e->getComponent<MovementComponent>("Movement");
+                sf::Vector2f position(hitbox->hitbox.left, hitbox->hitbox.top);
+
+                auto found = m_kinematics.find(e->getId());
+                if(found == m_kinematics.end() || found->second.velocity != movement->velocity || found->second.position != position)
+                {
+                    if(found != m_kinematics.end())
+                        m_impacts.invalidate(e->getId());
+
+                    Kinematic& kinematic = m_kinematics[e->getId()];
+                    kinematic.entity = e;
+                    kinematic.hitbox = hitbox;
+                    kinematic.origin = position;
+                    kinematic.velocity = movement->velocity;
+                    kinematic.start = m_time - elapsed;
+                    kinematic.scheduled = 0;
+
+                    m_started.push_back(e);
+                }
+
+                m_kinematics[e->getId()].seen = m_step;
+            }
+
+            // Then they all move to where they are at the end of the step.
+            for(kantan::Entity* e : m_kinematicBodies)
+            {
+                Kinematic& kinematic = m_kinematics[e->getId()];
+                kinematic.position = kinematic.origin + kinematic.velocity * (m_time - kinematic.start).asSeconds();
+
+                kinematic.hitbox->hitbox.left = kinematic.position.x;
+                kinematic.hitbox->hitbox.top = kinematic.position.y;
+            }
+
+            // Other bodies that appeared or moved.
+            m_changedTargets.clear();
+            for(unsigned int body(0) ; body < m_bodies.size() ; ++body)
+            {
+                unsigned int id = m_bodies[body]->getId();
+                auto found = m_targets.find(id);
+
+                if(found == m_targets.end() || found->second.box != m_hitboxes[body]->hitbox)
+                {
+                    if(found != m_targets.end())
+                        m_impacts.invalidate(id);
+
+                    m_targets[id].box = m_hitboxes[body]->hitbox;
+                    m_changedTargets.push_back(body);
+                }
+
+                m_targets[id].seen = m_step;
+            }
+
+            // The impacts of the removed bodies will never happen.
+            forgetRemoved(m_kinematics);
+            forgetRemoved(m_targets);
+
+            // Schedule the new impacts: the new motions against everything from the start of the step,
+            // and the changed bodies against the other motions from where the step left them.
+            const sf::Time stepStart = m_time - elapsed;
+
+            for(kantan::Entity* e : m_started)
+            {
+                Kinematic& kinematic = m_kinematics[e->getId()];
+
+                for(unsigned int body(0) ; body < m_bodies.size() ; ++body)
+                    scheduleImpact(kinematic, stepStart, m_bodies[body], m_hitboxes[body], m_hitboxes[body]->hitbox, sf::Vector2f(0.f, 0.f));
+
+                // Two new motions are scheduled by the first one only.
+                for(kantan::Entity* other : m_kinematicBodies)
+                {
+                    Kinematic& otherKinematic = m_kinematics[other->getId()];
+
+                    if(other != e && otherKinematic.scheduled != m_step)
+                        scheduleImpact(kinematic, stepStart, other, otherKinematic.hitbox, getBox(otherKinematic, stepStart), otherKinematic.velocity);
+                }
+
+                kinematic.scheduled = m_step;
+            }
+
+            for(unsigned int body : m_changedTargets)
+            {
+                for(kantan::Entity* e : m_kinematicBodies)
+                {
+                    Kinematic& kinematic = m_kinematics[e->getId()];
+
+                    if(kinematic.scheduled != m_step)
+                        scheduleImpact(kinematic, m_time, m_bodies[body], m_hitboxes[body], m_hitboxes[body]->hitbox, sf::Vector2f(0.f, 0.f));
+                }
+            }
+
+            // An impact is a contact until the boxes separate: the earlier ones still overlapping persist.
+            std::size_t kept = 0;
+            for(const kantan::ScheduledImpact& impact : m_touching)
+            {
+                sf::FloatRect projectileBox, targetBox;
+
+                if(findBox(impact.projectileId, projectileBox) && findBox(impact.targetId, targetBox) && projectileBox.intersects(targetBox))
+                {
+                    m_contactCache.add(impact.projectile, impact.target);
+                    m_touching[kept++] = impact;
+                }
+            }
+            m_touching.resize(kept);
+
+            // Record the impacts of the step.
+            m_dueImpacts.clear();
+            m_impacts.popDue(m_time, m_dueImpacts);
+
+            for(const kantan::ScheduledImpact& impact : m_dueImpacts)
+            {
+                m_contactCache.add(impact.projectile, impact.target);
+
+                bool tracked = std::any_of(m_touching.begin(), m_touching.end(), [&impact](const kantan::ScheduledImpact& other)
+                {
+                    return other.projectileId == impact.projectileId && other.targetId == impact.targetId;
+                });
+
+                if(!tracked)
+                    m_touching.push_back(impact);
+            }
+        }
+
+        // Box of a body at the end of the step, false if it was removed.
+        bool findBox(unsigned int id, sf::FloatRect& box) const
+        {
+            auto kinematic = m_kinematics.find(id);
+            if(kinematic != m_kinematics.end())
+            {
+                box = kinematic->second.hitbox->hitbox;
+                return true;
+            }
+
+            auto target = m_targets.find(id);
+            if(target != m_targets.end())
+            {
+                box = target->second.box;
+                return true;
+            }
+
+            return false;
+        }
+
+        // Box of a kinematic body at a given time.
+        sf::FloatRect getBox(const Kinematic& kinematic, sf::Time time) const
+        {
+            sf::Vector2f position = kinematic.origin + kinematic.velocity * (time - kinematic.start).asSeconds();
+            return sf::FloatRect(position, sf::Vector2f(kinematic.hitbox->hitbox.width, kinematic.hitbox->hitbox.height));
+        }
+
+        // Schedules the impact of a kinematic body with another body, whose box is given at the time from.
+        void scheduleImpact(const Kinematic& kinematic, sf::Time from, kantan::Entity* other, HitboxComponent* otherHitbox, const sf::FloatRect& otherBox, const sf::Vector2f& otherVelocity)
+        {
+            // Both must want the collision.
+            if(!kantan::CollisionMatrix::canCollide(kinematic.hitbox->layers, kinematic.hitbox->mask, otherHitbox->layers, otherHitbox->mask))
+                return;
+
+            kantan::SweepHit hit;
+            if(kantan::findTimeOfImpact(getBox(kinematic, from), kinematic.velocity, otherBox, otherVelocity, ImpactHorizon, hit))
+                m_impacts.schedule(from + sf::seconds(hit.time), kinematic.entity, other);
+        }
+
+        // Drops the bodies not seen during the step, and their impacts.
+        template<typename Map>
+        void forgetRemoved(Map& bodies)
+        {
+            for(auto itr = bodies.begin() ; itr != bodies.end() ;)
+            {
+                if(itr->second.seen != m_step)
+                {
+                    m_impacts.invalidate(itr->first);
+                    itr = bodies.erase(itr);
+                }
+                else
+                    ++itr;
+            }
+        }
+
+        // Moves the packed projectiles and records their contacts of the step.
+        void stepProjectiles(sf::Time elapsed)
+        {
+            if(m_projectilePath != PackedProjectiles)
+                return;
 
-                    // Check if first entity has a movement component, if not we'll wait the turn of the second entity to check the collision.
-                    if(!fst->hasComponent("Movement"))
-                        continue;
+            // Take the projectiles the game added, changed or removed. Their kind is their first collision layer.
+            m_projectiles.beginSync();
+            for(kantan::Entity* e : m_kinematicBodies)
+            {
+                HitboxComponent* hitbox = e->getComponent<HitboxComponent>("Hitbox");
+                MovementComponent* movement = e->getComponent<MovementComponent>("Movement");
 
-                    // We get the snd's hitbox.
-                    HitboxComponent* sndHitbox = snd->getComponent<HitboxComponent>("Hitbox");
+                unsigned int kind = 0;
+                while(kind < 31 && (hitbox->layers & (1u << kind)) == 0)
+                    ++kind;
 
-                    // We copy the fst's hitbox and apply the movement to it.
-                    sf::FloatRect fstNewHitbox = fstHitbox->hitbox;
-                    fstNewHitbox.left += fstMovement->velocity.x * elapsed.asSeconds();
-                    fstNewHitbox.top += fstMovement->velocity.y * elapsed.asSeconds();
+                m_projectiles.setKind(kind, sf::Vector2f(hitbox->hitbox.width, hitbox->hitbox.height), hitbox->layers, hitbox->mask);
+                m_projectiles.sync(e, sf::Vector2f(hitbox->hitbox.left, hitbox->hitbox.top), movement->velocity.y, kind);
+            }
+            m_projectiles.endSync();
 
-                    // Effective movement, will be used to compute the corrected velocity.
-                    sf::Vector2f movement(fstMovement->velocity.x * elapsed.asSeconds(), fstMovement->velocity.y * elapsed.asSeconds());
+            // Every other body, as it moved during the step.
+            m_projectileTargets.clear();
+            for(unsigned int body(0) ; body < m_bodies.size() ; ++body)
+            {
+                HitboxComponent* hitbox = m_hitboxes[body];
+                int mover = m_moverOf[body];
 
-                    // Now we check the collision & compute the movement corrections.
-                    if(fstNewHitbox.intersects(sndHitbox->hitbox))
-                    {
-                        // All checks are done relatively to the fst entity.
-                        // To know from where the collision comes, we look at where the hitboxes were before the movement application.
-                        // If the collision is from the bottom.
-                        if(fstHitbox->hitbox.top + fstHitbox->hitbox.height <= sndHitbox->hitbox.top)
-                        {
-                            movement.y = sndHitbox->hitbox.top - (fstHitbox->hitbox.top + fstHitbox->hitbox.height);
-                        }
-                        // If the collision is from the top.
-                        else if(fstHitbox->hitbox.top >= sndHitbox->hitbox.top + sndHitbox->hitbox.height)
-                        {
-                            movement.y = -(fstHitbox->hitbox.top - (sndHitbox->hitbox.top + sndHitbox->hitbox.height));
-                        }
-                        // If the collision is from the right.
-                        else if(fstHitbox->hitbox.left + fstHitbox->hitbox.width <= sndHitbox->hitbox.left)
-                        {
-                            movement.x = sndHitbox->hitbox.left - (fstHitbox->hitbox.left + fstHitbox->hitbox.width);
-                        }
-                        // If the collision is from the left.
-                        else if(fstHitbox->hitbox.left >= sndHitbox->hitbox.left + sndHitbox->hitbox.width)
-                        {
-                            movement.x = -(fstHitbox->hitbox.left - (sndHitbox->hitbox.left + sndHitbox->hitbox.width));
-                        }
-                        // Intern collision.
-                        else
-                        {
-                            // We'll see later what to do here.
-                        }
+                kantan::ProjectileTarget target{m_bodies[body], hitbox->hitbox, sf::Vector2f(0.f, 0.f), hitbox->layers, hitbox->mask};
+                if(mover >= 0)
+                {
+                    target.box.left = m_positionX[mover];
+                    target.box.top = m_positionY[mover];
+                    target.movement = sf::Vector2f(m_movementX[mover], m_movementY[mover]);
+                }
 
-                        // Record the collision.
-                        m_collisions.push_back(std::pair<kantan::Entity*, kantan::Entity*>(fst, snd));
-                    }
+                m_projectileTargets.push_back(target);
+            }
 
-                    // Change the velocity for the next entity check if both hitboxes are blocking.
-                    if(fstHitbox->isBlocking && sndHitbox->isBlocking)
-                    {
-                        fstMovement->velocity.x = movement.x / elapsed.asSeconds();
-                        fstMovement->velocity.y = movement.y / elapsed.asSeconds();
-                    }
-                }
+            m_projectileContacts.clear();
+            m_projectiles.step(elapsed.asSeconds(), m_projectileTargets, m_projectileContacts);
 
-                // Now we apply the corrected movement to the hitbox.
-                fstHitbox->hitbox.left += fstMovement->velocity.x * elapsed.asSeconds();
-                fstHitbox->hitbox.top += fstMovement->velocity.y * elapsed.asSeconds();
+            for(std::size_t i(0) ; i < m_projectiles.size() ; ++i)
+            {
+                HitboxComponent* hitbox = m_projectiles.getEntity(i)->getComponent<HitboxComponent>("Hitbox");
+                hitbox->hitbox.left = m_projectiles.getPosition(i).x;
+                hitbox->hitbox.top = m_projectiles.getPosition(i).y;
             }
+
+            for(const kantan::ProjectileContact& contact : m_projectileContacts)
+                m_contactCache.add(contact.first, contact.second);
         }
 
-        // Returns the collisions record.
-        std::vector<std::pair<kantan::Entity*, kantan::Entity*>> getCollisionRecord()
+        // Indexes the hitboxes where the step left them.
+        void buildIndex()
         {
-            return m_collisions;
+            m_spatialIndex.clear();
+
+            for(unsigned int body(0) ; body < m_bodies.size() ; ++body)
+                m_spatialIndex.insert(m_bodies[body], m_hitboxes[body]->hitbox, m_hitboxes[body]->layers);
+
+            for(kantan::Entity* e : m_kinematicBodies)
+            {
+                HitboxComponent* hitbox = e->getComponent<HitboxComponent>("Hitbox");
+                m_spatialIndex.insert(e, hitbox->hitbox, hitbox->layers);
+            }
         }
 
-    protected:
-        // Record of the collisions.
-        std::vector<std::pair<kantan::Entity*, kantan::Entity*>> m_collisions;
+        // Pairs in contact, from a step to the next.
+        kantan::ContactCache m_contactCache;
+
+        // Hitboxes at the end of the step.
+        kantan::SpatialGrid m_spatialIndex;
+
+        // Entities with a hitbox, their hitbox and their index in the movers (-1 if they do not move).
+        std::vector<kantan::Entity*> m_bodies;
+        std::vector<HitboxComponent*> m_hitboxes;
+        std::vector<int> m_moverOf;
+
+        // Movers: index in the bodies, position, velocity and movement during the step.
+        std::vector<unsigned int> m_movers;
+        std::vector<float> m_positionX, m_positionY;
+        std::vector<float> m_velocityX, m_velocityY;
+        std::vector<float> m_movementX, m_movementY;
+        std::vector<bool> m_corrected;
+
+        // Same data in fixed point, when it is enabled: the box of each body and the state of each mover.
+        bool m_fixedPoint;
+        std::vector<kantan::FixedRect> m_fixedBoxes;
+        std::vector<kantan::Fixed> m_fixedPositionX, m_fixedPositionY;
+        std::vector<kantan::Fixed> m_fixedVelocityX, m_fixedVelocityY;
+        std::vector<kantan::Fixed> m_fixedMovementX, m_fixedMovementY;
+
+        // Area covered by each body during the step, and the ones found by the kernel for the current mover.
+        kantan::AabbArrays m_sweeps;
+        kantan::AabbKernel m_kernel;
+        std::vector<unsigned int> m_candidates;
+
+        // Pairs found by the broadphase.
+        std::vector<Pair> m_pairs;
+
+        // Narrow phase threads and their contacts.
+        kantan::ThreadPool* m_threads;
+        std::vector<std::vector<Contact>> m_threadContacts;
+
+        // Contacts of the step, sorted by time.
+        std::vector<Contact> m_contacts;
+
+        // Impacts of the kinematic bodies, the ones handled this step and their state, by entity id.
+        ProjectilePath m_projectilePath;
+        sf::Time m_time;
+        unsigned int m_step;
+        kantan::ImpactScheduler m_impacts;
+        std::vector<kantan::ScheduledImpact> m_dueImpacts, m_touching;
+        std::vector<kantan::Entity*> m_kinematicBodies;
+        std::vector<kantan::Entity*> m_started;
+        std::vector<unsigned int> m_changedTargets;
+        std::unordered_map<unsigned int, Kinematic> m_kinematics;
+        std::unordered_map<unsigned int, Target> m_targets;
+
+        // Packed projectiles, the bodies they can hit and their contacts of the step.
+        kantan::ProjectileBatch m_projectiles;
+        std::vector<kantan::ProjectileTarget> m_projectileTargets;
+        std::vector<kantan::ProjectileContact> m_projectileContacts;
 };
 
 /*
     CollisionEffectsSystem.
-    Check the collisions record.
+    Applies the effects of the contacts, given as a view on the physics' contact cache.
 */
 class CollisionEffectsSystem : public kantan::System
 {
     public:
-        CollisionEffectsSystem(){}
+        CollisionEffectsSystem()
+        {
+            using namespace std::placeholders;
 
-        // Sets the collision record.
-        void setCollisionRecord(std::vector<std::pair<kantan::Entity*, kantan::Entity*>> collisions)
+            m_responses.registerHandler("Sakura", "Ball", std::bind(&CollisionEffectsSystem::onSakuraHitsBall, _1, _2, _3));
+            m_responses.registerHandler("Ball", "Box", std::bind(&CollisionEffectsSystem::onBallHitsWall, _1, _2, _3));
+            m_responses.registerHandler("Ball", "Player", std::bind(&CollisionEffectsSystem::onBallHitsPlayer, _1, _2, _3));
+        }
+
+        // Gives an entity the index of its kind in the responses, once when it is created.
+        void assignKind(kantan::Entity* entity) const
+        {
+            m_responses.assignKind(entity);
+        }
+
+        // Sets the contacts to handle during the next update.
+        void setContacts(kantan::ContactView contacts)
         {
-            m_collisions = collisions;
+            m_contacts = contacts;
         }
 
         // Updates.
         virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
         {
-            for(std::pair<kantan::Entity*, kantan::Entity*> collision : m_collisions)
-            {
-                // When a sakura hits a ball, they die.
-                if(collision.first->getName() == "Sakura" && collision.second->getName() == "Ball")
-                {
-                    collision.second->getComponent<LifeComponent>("Life")->lifepoints = 0;
-                    collision.first->getComponent<LifeComponent>("Life")->lifepoints = 0;
-
-                    DeletionMarkerComponent* dmc = collision.first->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
+            for(const kantan::ContactEvent& collision : m_contacts)
+                m_responses.dispatch(collision.first, collision.second, eventQueue);
 
-                    dmc = collision.second->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
-
-                    // Create event.
-                    kantan::Event* event = new kantan::Event(EventType::ColoredBallShot);
-
-                    // Get ball color and center.
-                    SpriteComponent* sprite = collision.second->getComponent<SpriteComponent>("Sprite");
-                    sf::Color color;
+            // Then forget them, the view does not outlive the physics step.
+            m_contacts = kantan::ContactView();
+        }
 
-                    if(sprite->sprite.getTextureRect().left < 64)
-                        color = sf::Color::Red;
-                    else if(sprite->sprite.getTextureRect().left < 64*2)
-                        color = sf::Color::Blue;
-                    else if(sprite->sprite.getTextureRect().left < 64*3)
-                        color = sf::Color::Green;
-                    else
-                        color = sf::Color::Yellow;
+    protected:
+        // When a sakura hits a ball, they die.
+        static void onSakuraHitsBall(kantan::Entity* sakura, kantan::Entity* ball, std::queue<kantan::Event*>& eventQueue)
+        {
+            ball->getComponent<LifeComponent>("Life")->lifepoints = 0;
+            sakura->getComponent<LifeComponent>("Life")->lifepoints = 0;
 
-                    sf::Vector2f center;
-                    center.x = sprite->sprite.getGlobalBounds().left + sprite->sprite.getGlobalBounds().width / 2;
-                    center.y = sprite->sprite.getGlobalBounds().top + sprite->sprite.getGlobalBounds().height / 2;
+            DeletionMarkerComponent* dmc = sakura->getComponent<DeletionMarkerComponent>("DeletionMarker");
+            dmc->toDelete = true;
 
-                    ColoredBallShotData* cbsd = new ColoredBallShotData(color, center);
+            dmc = ball->getComponent<DeletionMarkerComponent>("DeletionMarker");
+            dmc->toDelete = true;
 
-                    // Attach data to event.
-                    event->bindEventData(cbsd);
+            // Create event.
+            kantan::Event* event = new kantan::Event(EventType::ColoredBallShot);
 
-                    // Push event in queue.
-                    eventQueue.push(event);
-                }
-                // When a ball hits a wall, it dies.
-                else if(collision.first->getName() == "Ball" && collision.second->getName() == "Box")
-                {
-                    collision.first->getComponent<LifeComponent>("Life")->lifepoints = 0;
+            // Get ball color and center.
+            SpriteComponent* sprite = ball->getComponent<SpriteComponent>("Sprite");
+            sf::Color color = ball->getComponent<ColorComponent>("Color")->color;
 
-                    DeletionMarkerComponent* dmc = collision.first->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
-                }
-                else if(collision.first->getName() == "Box" && collision.second->getName() == "Ball")
-                {
-                    collision.second->getComponent<LifeComponent>("Life")->lifepoints = 0;
+            sf::Vector2f center;
+            center.x = sprite->sprite.getGlobalBounds().left + sprite->sprite.getGlobalBounds().width / 2;
+            center.y = sprite->sprite.getGlobalBounds().top + sprite->sprite.getGlobalBounds().height / 2;
 
-                    DeletionMarkerComponent* dmc = collision.second->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
-                }
-                // When a ball hits the player.
-                else if(collision.first->getName() == "Ball" && collision.second->getName() == "Player")
-                {
-                    // Kill the ball.
-                    collision.first->getComponent<LifeComponent>("Life")->lifepoints = 0;
+            ColoredBallShotData* cbsd = new ColoredBallShotData(color, center);
 
-                    DeletionMarkerComponent* dmc = collision.first->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
+            // Attach data to event.
+            event->bindEventData(cbsd);
 
-                    // Decrease player's life.
-                    LifeComponent* life = collision.second->getComponent<LifeComponent>("Life");
-                    life->lifepoints--;
+            // Push event in queue.
+            eventQueue.push(event);
+        }
 
-                    // Create event.
-                    kantan::Event* event = new kantan::Event(EventType::PlayerHit);
+        // When a ball hits a wall, it dies.
+        static void onBallHitsWall(kantan::Entity* ball, kantan::Entity*, std::queue<kantan::Event*>&)
+        {
+            ball->getComponent<LifeComponent>("Life")->lifepoints = 0;
 
-                    // Push event in queue.
-                    eventQueue.push(event);
-                }
-                else if(collision.first->getName() == "Player" && collision.second->getName() == "Ball")
-                {
-                    // Kill the ball.
-                    collision.second->getComponent<LifeComponent>("Life")->lifepoints = 0;
+            DeletionMarkerComponent* dmc = ball->getComponent<DeletionMarkerComponent>("DeletionMarker");
+            dmc->toDelete = true;
+        }
 
-                    DeletionMarkerComponent* dmc = collision.second->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
+        // When a ball hits the player.
+        static void onBallHitsPlayer(kantan::Entity* ball, kantan::Entity* player, std::queue<kantan::Event*>& eventQueue)
+        {
+            // Kill the ball.
+            ball->getComponent<LifeComponent>("Life")->lifepoints = 0;
 
-                    // Decrease player's life.
-                    LifeComponent* life = collision.first->getComponent<LifeComponent>("Life");
-                    life->lifepoints--;
+            DeletionMarkerComponent* dmc = ball->getComponent<DeletionMarkerComponent>("DeletionMarker");
+            dmc->toDelete = true;
 
-                    // Create event.
-                    kantan::Event* event = new kantan::Event(EventType::PlayerHit);
+            // Decrease player's life.
+            LifeComponent* life = player->getComponent<LifeComponent>("Life");
+            life->lifepoints--;
 
-                    // Push event in queue.
-                    eventQueue.push(event);
-                }
-            }
+            // Create event.
+            kantan::Event* event = new kantan::Event(EventType::PlayerHit);
 
-            // Then clear.
-            m_collisions.clear();
+            // Push event in queue.
+            eventQueue.push(event);
         }
 
-    protected:
-        // Collisions record.
-        std::vector<std::pair<kantan::Entity*, kantan::Entity*>> m_collisions;
+        // Contacts to handle.
+        kantan::ContactView m_contacts;
+
+        // Responses, by pair of entity kinds.
+        kantan::CollisionResponseRegistry m_responses;
 };
 
 /*
@@ -458,7 +1190,15 @@ class CollisionEffectsSystem : public kantan::System
 class SynchronizeSystem : public kantan::System
 {
     public:
-        SynchronizeSystem(){}
+        SynchronizeSystem()
+            : m_alpha(1.f)
+        {}
+
+        // Sets where to render between the previous and the current position of the hitboxes (1 is the current one).
+        void setInterpolation(float alpha)
+        {
+            m_alpha = alpha;
+        }
 
         // Update.
         virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
@@ -474,9 +1214,19 @@ class SynchronizeSystem : public kantan::System
                 SpriteComponent* sprite = e->getComponent<SpriteComponent>(std::string("Sprite"));
 
                 // Update sprite's position with hitbox's position.
-                sprite->sprite.setPosition(hitbox->hitbox.left, hitbox->hitbox.top);
+                if(hitbox->hasPreviousPosition && m_alpha < 1.f)
+                {
+                    sf::Vector2f current(hitbox->hitbox.left, hitbox->hitbox.top);
+                    sprite->sprite.setPosition(hitbox->previousPosition + (current - hitbox->previousPosition) * m_alpha);
+                }
+                else
+                    sprite->sprite.setPosition(hitbox->hitbox.left, hitbox->hitbox.top);
             }
         }
+
+    protected:
+        // Interpolation factor.
+        float m_alpha;
 };
 
 /*
@@ -492,12 +1242,11 @@ class AnimationSystem : public kantan::System
         {
             for(kantan::Entity* e : entities)
             {
-                // We need an animation and a sprite.
-                if(!e->hasComponent("Sprite") || !e->hasComponent("Animation"))
+                // We need an animation, and a sprite or a static quad.
+                if(!e->hasComponent("Animation") || (!e->hasComponent("Sprite") && !e->hasComponent("StaticQuad")))
                     continue;
 
-                // Get the components.
-                SpriteComponent* sprite = e->getComponent<SpriteComponent>("Sprite");
+                // Get the component.
                 AnimationComponent* animation = e->getComponent<AnimationComponent>("Animation");
 
                 // Update time since last frame.
@@ -515,8 +1264,18 @@ class AnimationSystem : public kantan::System
                     else
                         animation->currentFrame++;
 
-                    // Get the next frame and apply it to the sprite.
-                    sprite->sprite.setTextureRect(animation->frames[animation->currentFrame]);
+                    // Get the next frame and apply it to the sprite, or to the quad (uploaded with the others of its geometry).
+                    const sf::IntRect& frame = animation->frames[animation->currentFrame];
+
+                    if(e->hasComponent("Sprite"))
+                    {
+                        e->getComponent<SpriteComponent>("Sprite")->sprite.setTextureRect(frame);
+                    }
+                    else
+                    {
+                        StaticQuadComponent* quad = e->getComponent<StaticQuadComponent>("StaticQuad");
+                        quad->geometry->setTextureRect(quad->quad, frame);
+                    }
                 }
             }
         }
@@ -528,7 +1287,9 @@ class AnimationSystem : public kantan::System
 class SpriteRenderSystem : public kantan::System
 {
     public:
-        SpriteRenderSystem(sf::RenderWindow* window) : m_window(window)
+        SpriteRenderSystem(sf::RenderWindow* window, kantan::CommandBuffer* commands)
+            : m_window(window)
+            , m_commands(commands)
         {}
 
         // Update.
@@ -543,17 +1304,20 @@ class SpriteRenderSystem : public kantan::System
                 if(!e->hasComponent("Sprite"))
                     continue;
 
-                // Get the sprite component and render it.
+                // Get the sprite component and record it.
                 SpriteComponent* sprite = e->getComponent<SpriteComponent>("Sprite");
 
                 if(viewHitbox.intersects(sprite->sprite.getGlobalBounds()))
-                    m_window->draw(sprite->sprite);
+                    m_commands->draw(sprite->sprite, sprite->layer);
             }
         }
 
     protected:
         // Window ptr.
         sf::RenderWindow* m_window;
+
+        // Draw commands of the frame.
+        kantan::CommandBuffer* m_commands;
 };
 
 /*
@@ -599,53 +1363,19 @@ class LifeSystem : public kantan::System
 class ParticleWatcherSystem : public kantan::System
 {
     public:
-        ParticleWatcherSystem(){}
+        ParticleWatcherSystem(kantan::ParticleEngine* particles) : m_particles(particles)
+        {}
 
         // Update.
         virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
         {
-            for(kantan::Entity* e : entities)
-            {
-                // We need a particle component.
-                if(!e->hasComponent("Particle"))
-                    continue;
-
-                // Get the particles system.
-                ParticleComponent* particles = e->getComponent<ParticleComponent>("Particle");
-
-                // Get the lifetime of the overall system.
-                particles->lifetime += elapsed;
-
-                // Check if the system is outdated.
-                if(particles->lifetime >= sf::seconds(2.f))
-                {
-                    // Ask for deletion.
-                    DeletionMarkerComponent* dmc = e->getComponent<DeletionMarkerComponent>("DeletionMarker");
-                    dmc->toDelete = true;
-
-                    // No need to update the visual aspect.
-                    continue;
-                }
-
-                // Update each individual particle of the particle system.
-                for(std::size_t i = 0 ; i < particles->m_particles.size() ; ++i)
-                {
-                    // Update particle lifetime.
-                    ParticleComponent::Particle& p = particles->m_particles[i];
-                    p.lifetime -= elapsed;
-
-                    // Update the position of the vertex corresponding.
-                    particles->m_vertices[i].position += p.velocity * elapsed.asSeconds();
-
-                    // Update alpha ratio.
-                    float ratio = p.lifetime.asSeconds();
-                    particles->m_vertices[i].color.a = static_cast<sf::Uint8>(ratio * 255);
-                }
-            }
+            // Move the particles, update their vertices and drop the finished explosions.
+            m_particles->update(elapsed);
         }
 
     protected:
-
+        // Particles of the world.
+        kantan::ParticleEngine* m_particles;
 };
 
 /*
@@ -654,26 +1384,24 @@ class ParticleWatcherSystem : public kantan::System
 class ParticleRenderSystem : public kantan::System
 {
     public:
-        ParticleRenderSystem(sf::RenderWindow* window) : m_window(window)
+        ParticleRenderSystem(kantan::CommandBuffer* commands, kantan::ParticleEngine* particles)
+            : m_commands(commands)
+            , m_particles(particles)
         {}
 
         // Update.
         virtual void update(sf::Time elapsed, std::vector<kantan::Entity*>& entities, std::queue<kantan::Event*>& eventQueue)
         {
-            for(kantan::Entity* e : entities)
-            {
-                // We need a particle component to render.
-                if(!e->hasComponent("Particle"))
-                    continue;
-
-                ParticleComponent* particles = e->getComponent<ParticleComponent>("Particle");
-                m_window->draw(particles->m_vertices);
-            }
+            // All the live particles are contiguous, one command for all of them, under the sprites.
+            m_commands->draw(m_particles->getVertices(), m_particles->size(), sf::Points, kantan::RenderResources::NoResource, ParticleDrawLayer);
         }
 
     protected:
-        // Render window.
-        sf::RenderWindow* m_window;
+        // Draw commands of the frame.
+        kantan::CommandBuffer* m_commands;
+
+        // Particles of the world.
+        kantan::ParticleEngine* m_particles;
 };
 
 /**
@@ -691,14 +1419,42 @@ class World
             , m_isRunning(true)
             , m_difficulty(difficulty)
             , m_lastMusic(0)
-            , m_spriteRender(window)
-            , m_particleRender(window)
+            , m_scoreWidget(0)
+            , m_comboWidget(0)
+            , m_affinityWidget(0)
+            , m_lifeWidget(0)
+            , m_sugoiWidget(0)
+            , m_hudScore(-1)
+            , m_hudCombo(-1)
+            , m_commands(&m_renderResources)
+            , m_renderBackend(&m_renderResources)
+            , m_particles(PARTICLE_CAPACITY)
+            , m_particleBudget(sf::seconds(FRAME_BUDGET / 1000.f))
+            , m_spriteRender(window, &m_commands)
+            , m_particleRender(&m_commands, &m_particles)
+            , m_particleWatcher(&m_particles)
             , m_colorAffinity(sf::Color::Red)
             , m_score(0)
             , m_combo(0)
             , m_lastSugoiDisplay(sf::seconds(1000.f))
             , m_lastAffinityChange(sf::Time::Zero)
+            , m_timestep(TICK_RATE, MAX_CATCH_UP_STEPS)
+            , m_threads(WORKER_THREADS)
+            , m_mortonOrder(32.f, MORTON_BUDGET)
         {
+            m_physics.setThreadPool(&m_threads);
+            m_physics.setFixedPoint(FIXED_POINT_PHYSICS);
+            m_physics.setProjectilePath(PROJECTILE_PATH);
+            m_particles.setSeed(static_cast<sf::Uint32>(std::rand()));
+            m_particles.setBudget(PARTICLE_BUDGET);
+            m_particles.setThreadPool(&m_threads);
+
+            // Which layers collide.
+            m_collisionMatrix.setInteraction(PlayerLayer, WallLayer);
+            m_collisionMatrix.setInteraction(PlayerLayer, BallLayer);
+            m_collisionMatrix.setInteraction(BallLayer, WallLayer);
+            m_collisionMatrix.setInteraction(BallLayer, SakuraLayer);
+
             switch(difficulty)
             {
                 case Difficulty::EASY:
@@ -761,15 +1517,32 @@ class World
         void init()
         {
             // Load assets.
-            m_textures.load(0, "media/textures/smallboxAnimated.png");
-            m_textures.load(1, "media/textures/littlesakura.png");
-            m_textures.load(2, "media/textures/player.png");
-            m_textures.load(3, "media/textures/balls.png");
-            m_textures.load(4, "media/textures/heart.png");
-            m_textures.load(5, "media/textures/sugoi.png");
+            m_atlas.load(0, "media/textures/smallboxAnimated.png");
+            m_atlas.load(1, "media/textures/littlesakura.png");
+            m_atlas.load(2, "media/textures/player.png");
+            m_atlas.load(3, "media/textures/balls.png");
+            m_atlas.load(4, "media/textures/heart.png");
+            m_atlas.load(5, "media/textures/sugoi.png");
+            m_atlas.build();
 
             m_fonts.load(0, "media/fonts/OpenSans-Regular.ttf");
 
+            m_renderResources.addTexture(0, m_atlas.getTexture());
+            m_renderResources.addFont(0, m_fonts.get(0));
+
+            m_walls.setTexture(&m_atlas.getTexture());
+            m_renderResources.addDrawable(0, m_walls);
+
+            // Glyphs of the HUD texts, rasterized now rather than on the first score or combo (the score can go below 0).
+            kantan::GlyphCache glyphs;
+            glyphs.addFont("media/fonts/OpenSans-Regular.ttf", m_fonts.get(0));
+            glyphs.declare("media/fonts/OpenSans-Regular.ttf", 48, "Score:Combo +-0123456789");
+            glyphs.declare("media/fonts/OpenSans-Regular.ttf", 52, "COMBO: +0123456789");
+            glyphs.bake();
+
+            buildHud();
+            m_renderResources.addDrawable(1, m_hud);
+
             m_sugoiSoundBuffer.loadFromFile("media/musics/sectionpass.wav");
             m_sugoiSound.setBuffer(m_sugoiSoundBuffer);
 
@@ -808,10 +1581,91 @@ class World
             // Music.
             updatePlaylist();
 
-            // Do not take too big time step.
-            if(dt.asSeconds() > 0.5f)
-                dt = sf::seconds(0.5f);
+            // Work of the frame, up to the end of render(): dt also holds the wait for the display (vsync).
+            m_frameWork.restart();
+
+            // Run the simulation at a fixed rate, whatever the frame rate.
+            unsigned int steps = m_timestep.advance(dt);
+
+            for(unsigned int i(0) ; i < steps && m_isRunning ; ++i)
+                tick(m_timestep.getStep());
+        }
+
+        // Sets the simulation rate, in steps per second.
+        void setTickRate(unsigned int tickRate)
+        {
+            m_timestep.setTickRate(tickRate);
+        }
+
+        // Sets the max number of steps run to catch up with one frame.
+        void setMaxCatchUpSteps(unsigned int maxSteps)
+        {
+            m_timestep.setMaxSteps(maxSteps);
+        }
+
+        void render()
+        {
+            // Render the entities between the last two steps.
+            m_synchronize.setInterpolation(m_timestep.getAlpha());
+            m_synchronize.update(sf::Time::Zero, m_entities, m_eventQueue);
+            m_synchronize.setInterpolation(1.f);
+
+            // Walls, in one draw, their animation frame uploaded if it changed.
+            m_walls.update();
+            m_commands.drawResource(0, WallDrawLayer);
+
+            // Entities.
+            m_particleRender.update(sf::Time::Zero, m_entities, m_eventQueue);
+            m_spriteRender.update(sf::Time::Zero, m_entities, m_eventQueue);
+
+            // GUI, cached until what it shows changes.
+            updateHud();
+            m_commands.drawResource(1, HudDrawLayer);
+
+            // Everything is drawn by layer then texture: the atlas sprites of all the layers in one call.
+            m_renderBackend.execute(m_commands, *m_window);
+
+            // A capture that cannot be written is reported, the game goes on.
+            if(!m_captureFile.empty())
+            {
+                try
+                {
+                    m_commands.saveToFile(m_captureFile);
+                }
+                catch(const std::runtime_error& error)
+                {
+                    std::cerr << "Frame capture failed: " << error.what() << std::endl;
+                }
+
+                m_captureFile.clear();
+            }
+
+            m_commands.clear();
+
+            // Time spent on the frame, for the level of detail of the particles.
+            m_particleBudget.recordFrame(m_frameWork.getElapsedTime());
+        }
+
+        // Saves the draw commands of the next frame to a file, to replay it without the game.
+        void captureFrame(const std::string& filename)
+        {
+            m_captureFile = filename;
+        }
+
+        int getScore()
+        {
+            return m_score;
+        }
+
+        bool isRunning()
+        {
+            return m_isRunning;
+        }
 
+    protected:
+        // One step of simulation.
+        void tick(sf::Time dt)
+        {
             /// Update the timers.
             m_lastSakuraShoot += dt;
             m_lastBallSpawn += dt;
@@ -826,8 +1680,8 @@ class World
             if(sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && m_lastSakuraShoot > sf::milliseconds(SHOOT_INTERVAL))
             {
                 HitboxComponent* hitbox = m_player->getComponent<HitboxComponent>("Hitbox");
-                shootSakura(sf::Vector2f(hitbox->hitbox.left + hitbox->hitbox.width / 2.f - m_textures.get(1).getSize().x / 2.f,
-                                         hitbox->hitbox.top - hitbox->hitbox.height / 2.f - m_textures.get(1).getSize().y / 2.f));
+                shootSakura(sf::Vector2f(hitbox->hitbox.left + hitbox->hitbox.width / 2.f - m_atlas.getRect(1).width / 2.f,
+                                         hitbox->hitbox.top - hitbox->hitbox.height / 2.f - m_atlas.getRect(1).height / 2.f));
                 m_lastSakuraShoot = sf::Time::Zero;
             }
 
@@ -852,7 +1706,7 @@ class World
             m_synchronize.update(dt, m_entities, m_eventQueue);
 
             /// Collision effects.
-            m_collider.setCollisionRecord(m_physics.getCollisionRecord());
+            m_collider.setContacts(m_physics.getContacts().getBegan());
             m_collider.update(dt, m_entities, m_eventQueue);
 
             m_lifes.update(dt, m_entities, m_eventQueue);
@@ -886,9 +1740,9 @@ class World
                         break;
                     case EventType::ColoredBallShot:
                         {
-                            // Make an explosion.
+                            // Make an explosion, the ones of the affinity color are culled last.
                             ColoredBallShotData* cbsd = event.getEventData<ColoredBallShotData>();
-                            createExplosion(cbsd->color, cbsd->center);
+                            createExplosion(cbsd->color, cbsd->center, cbsd->color == m_colorAffinity ? 1 : 0);
 
                             // Update score and combo.
                             if(cbsd->color == m_colorAffinity)
@@ -954,35 +1808,25 @@ class World
 
             /// Clean all the entities.
             cleanEntities();
-        }
-
-        void render()
-        {
-            // Entities.
-            m_particleRender.update(sf::Time::Zero, m_entities, m_eventQueue);
-            m_spriteRender.update(sf::Time::Zero, m_entities, m_eventQueue);
-
-            // GUI.
-            renderPlayerLife();
-            renderPlayerScore();
-            renderPlayerCombo();
-            renderColorAffinity();
 
-            if(m_combo > COMBO_MIN && m_combo % SUGOI_COMBO == 0 && m_lastSugoiDisplay < sf::seconds(1.5f))
-                renderSugoi();
+            /// Keep the entities close in space close in memory (changes which of two overlapping sprites of a layer is on top).
+            if(MORTON_REORDER)
+                reorderEntities();
         }
 
-        int getScore()
+        // Moves the entities toward the Z-order of their hitbox, a few per step.
+        void reorderEntities()
         {
-            return m_score;
-        }
+            m_mortonOrder.refine(m_entities, [this](kantan::Entity* e)
+            {
+                if(!e->hasComponent("Hitbox"))
+                    return kantan::MortonOrder::NoCode;
 
-        bool isRunning()
-        {
-            return m_isRunning;
+                const sf::FloatRect& hitbox = e->getComponent<HitboxComponent>("Hitbox")->hitbox;
+                return m_mortonOrder.getCode(sf::Vector2f(hitbox.left + hitbox.width / 2.f, hitbox.top + hitbox.height / 2.f));
+            });
         }
 
-    protected:
         // Remove all the entities and their components if they are marked as "to delete".
         void cleanEntities()
         {
@@ -1002,7 +1846,8 @@ class World
                             m_components.erase(itr_c);
                     }
 
-                    // Then delete the entity.
+                    // Then delete the entity, which the spatial queries must not return anymore.
+                    m_physics.forget(*itr_e);
                     m_entities.erase(itr_e);
                 }
                 else
@@ -1014,6 +1859,7 @@ class World
         kantan::Entity* createEntity(std::string name)
         {
             kantan::Entity* e = new kantan::Entity(name);
+            m_collider.assignKind(e);
 
             DeletionMarkerComponent* dmc = createComponent<DeletionMarkerComponent>();
             e->addComponent(dmc);
@@ -1031,29 +1877,37 @@ class World
             return c;
         }
 
+        // Puts a hitbox on a collision layer.
+        void setCollisionLayer(HitboxComponent* hitbox, CollisionLayer layer)
+        {
+            hitbox->layers = kantan::CollisionMatrix::getBit(layer);
+            hitbox->mask = m_collisionMatrix.getMask(layer);
+        }
+
         // Create a box.
         void createBox(sf::Vector2f position)
         {
             // Create entity & components.
             kantan::Entity* box = createEntity("Box");
 
-            SpriteComponent* sprite = createComponent<SpriteComponent>();
+            StaticQuadComponent* quad = createComponent<StaticQuadComponent>();
             HitboxComponent* hitbox = createComponent<HitboxComponent>();
             AnimationComponent* animation = createComponent<AnimationComponent>();
 
-            // Configure components.
-            sprite->sprite.setTexture(m_textures.get(0));
-            sprite->sprite.setTextureRect(sf::IntRect(0, 0, 64, 64));
+            // Configure components, the box never moves: it is drawn with the other walls.
             hitbox->hitbox = sf::FloatRect(position, sf::Vector2f(64.f, 64.f));
+            setCollisionLayer(hitbox, WallLayer);
+            quad->geometry = &m_walls;
+            quad->quad = m_walls.addQuad(hitbox->hitbox, m_atlas.map(0, sf::IntRect(0, 0, 64, 64)));
 
             for(unsigned int i(0) ; i < 18 ; ++i)
-                animation->frames.push_back(sf::IntRect(64 * i, 0, 64, 64));
+                animation->frames.push_back(m_atlas.map(0, sf::IntRect(64 * i, 0, 64, 64)));
             for(unsigned int i(0) ; i < 18 ; ++i)
-                animation->frames.push_back(sf::IntRect(64 * i, 64, 64, 64));
+                animation->frames.push_back(m_atlas.map(0, sf::IntRect(64 * i, 64, 64, 64)));
             animation->fps = 24;
 
             // Add components.
-            box->addComponent(sprite);
+            box->addComponent(quad);
             box->addComponent(hitbox);
             box->addComponent(animation);
         }
@@ -1086,9 +1940,12 @@ class World
             LifeComponent* life = createComponent<LifeComponent>();
 
             // Configure components.
-            sprite->sprite.setTexture(m_textures.get(1));
+            m_atlas.apply(sprite->sprite, 1);
+            sprite->layer = ProjectileDrawLayer;
             hitbox->hitbox = sf::FloatRect(position, sf::Vector2f(sprite->sprite.getGlobalBounds().width, sprite->sprite.getGlobalBounds().height));
             hitbox->isBlocking = false;
+            hitbox->isKinematic = true;
+            setCollisionLayer(hitbox, SakuraLayer);
             movement->velocity = sf::Vector2f(0.f, SAKURA_VELOCITY);
             life->lifepoints = 1;
 
@@ -1111,8 +1968,10 @@ class World
             LifeComponent* life = createComponent<LifeComponent>();
 
             // Configure components.
-            sprite->sprite.setTexture(m_textures.get(2));
+            m_atlas.apply(sprite->sprite, 2);
+            sprite->layer = PlayerDrawLayer;
             hitbox->hitbox = sf::FloatRect(sf::Vector2f(65, 640), sf::Vector2f(sprite->sprite.getGlobalBounds().width, sprite->sprite.getGlobalBounds().height));
+            setCollisionLayer(hitbox, PlayerLayer);
             movement->velocity = sf::Vector2f(0.f, 0.f);
             life->lifepoints = LIFE_POINTS;
 
@@ -1126,8 +1985,12 @@ class World
         // Create a ball.
         void createBall()
         {
-            // Generate random x.
+            // Generate random x, a few times if a ball that just spawned is still there.
             int randomX = 65 + ((std::rand() * 1000) % 576);
+
+            for(int attempt(0) ; attempt < 4 && isSpawnTaken(sf::FloatRect(randomX, -64.f, 64.f, 64.f)) ; ++attempt)
+                randomX = 65 + ((std::rand() * 1000) % 576);
+
             int randomColor = 64 * (rand() % (int)(3 + 1));
 
             // Create entity & components.
@@ -1137,12 +2000,19 @@ class World
             HitboxComponent* hitbox = createComponent<HitboxComponent>();
             MovementComponent* movement = createComponent<MovementComponent>();
             LifeComponent* life = createComponent<LifeComponent>();
+            ColorComponent* color = createComponent<ColorComponent>();
 
             // Configure components.
-            sprite->sprite.setTexture(m_textures.get(3));
-            sprite->sprite.setTextureRect(sf::IntRect(randomColor, 0, 64, 64));
+            m_atlas.apply(sprite->sprite, 3, sf::IntRect(randomColor, 0, 64, 64));
+            sprite->layer = ProjectileDrawLayer;
+
+            const sf::Color colors[] = {sf::Color::Red, sf::Color::Blue, sf::Color::Green, sf::Color::Yellow};
+            color->color = colors[randomColor / 64];
+
             hitbox->hitbox = sf::FloatRect(sf::Vector2f(randomX, -64.f), sf::Vector2f(64.f, 64.f));
             hitbox->isBlocking = false;
+            hitbox->isKinematic = true;
+            setCollisionLayer(hitbox, BallLayer);
             movement->velocity = sf::Vector2f(0.f, BALL_VELOCITY);
             life->lifepoints = 1;
 
@@ -1151,110 +2021,106 @@ class World
             box->addComponent(hitbox);
             box->addComponent(movement);
             box->addComponent(life);
+            box->addComponent(color);
         }
 
-        void createExplosion(sf::Color color, sf::Vector2f position)
+        // Returns true if a ball was in the region at the end of the last step.
+        bool isSpawnTaken(const sf::FloatRect& region)
         {
-            // Create entity & components.
-            kantan::Entity* explosion = createEntity("Explosion");
-
-            ParticleComponent* particles = createComponent<ParticleComponent>();
-
-            // Configure components.
-            particles->color = color;
-            particles->center = position;
-            particles->init();
-
-            // Add components.
-            explosion->addComponent(particles);
+            m_spawnQuery.clear();
+            return m_physics.getSpatialIndex().queryRegion(region, m_spawnQuery, kantan::SpatialFilter(kantan::CollisionMatrix::getBit(BallLayer))) != 0;
         }
 
-        // Render the player's score.
-        void renderPlayerScore()
+        void createExplosion(sf::Color color, sf::Vector2f position, int priority)
         {
-            sf::Text scoreText;
-            scoreText.setFont(m_fonts.get(0));
-            scoreText.setCharacterSize(48);
-            scoreText.setString(std::string("Score:") + to_string(m_score));
-            scoreText.setPosition(5.f, 5.f);
-
-            sf::RectangleShape bg;
-            bg.setSize(sf::Vector2f(scoreText.getGlobalBounds().width + 20.f, scoreText.getGlobalBounds().height + 20.f));
-            bg.setPosition(scoreText.getPosition());
-            bg.setFillColor(sf::Color(0, 0, 0, 120));
-
-            m_window->draw(bg);
-            m_window->draw(scoreText);
+            // A burst of up to 1000 particles in the shared pool, for 2 seconds, fewer when the frames or the pool are loaded.
+            kantan::ParticleBurst burst;
+            burst.center = position;
+            burst.color = color;
+            burst.count = m_particleBudget.getCount(1000, m_particles.getLiveCount(), m_particles.getBudget());
+            burst.priority = priority;
+            burst.duration = sf::seconds(2.f);
+            burst.minSpeed = 20.f;
+            burst.maxSpeed = 70.f;
+            burst.minLifetime = sf::seconds(1.f);
+            burst.maxLifetime = sf::seconds(3.f);
+
+            m_particles.addBurst(burst);
         }
 
-        // Render the player's combo if any.
-        void renderPlayerCombo()
+        // Creates the widgets of the HUD, laid out again only when what they show changes.
+        void buildHud()
         {
-            sf::Text comboText;
-            comboText.setFont(m_fonts.get(0));
+            m_hud.create(m_window->getSize());
 
-            // If good combo, be special.
-            if(m_combo > COMBO_MIN)
-            {
-                comboText.setCharacterSize(52);
-                comboText.setFillColor(sf::Color::Yellow);
-                comboText.setString(std::string("COMBO: +") + to_string(m_combo));
-            }
-            else
-            {
-                comboText.setCharacterSize(48);
-                comboText.setString(std::string("Combo: ") + to_string(m_combo));
-            }
+            // Score and combo.
+            m_scoreWidget = m_hud.addText(m_fonts.get(0), 48, sf::Vector2f(5.f, 5.f), sf::Color(0, 0, 0, 120), 20.f);
+            m_comboWidget = m_hud.addText(m_fonts.get(0), 48, sf::Vector2f(5.f, 60.f), sf::Color(0, 0, 0, 120), 20.f);
 
-            comboText.setPosition(5.f, 60.f);
+            // Color affinity.
+            sf::Sprite affinity;
+            m_atlas.apply(affinity, 3, sf::IntRect(0, 0, 64, 64));
+            affinity.setScale(1.5f, 1.5f);
+            affinity.setPosition(m_window->getSize().x - affinity.getGlobalBounds().width - 20.f, 20.f);
+            m_affinityWidget = m_hud.addSprites(affinity, sf::Vector2f(0.f, 0.f));
 
-            sf::RectangleShape bg;
-            bg.setSize(sf::Vector2f(comboText.getGlobalBounds().width + 20.f, comboText.getGlobalBounds().height + 20.f));
-            bg.setPosition(comboText.getPosition());
-            bg.setFillColor(sf::Color(0, 0, 0, 120));
+            // Hearts of the player's life.
+            sf::Sprite heart;
+            m_atlas.apply(heart, 4);
+            heart.setPosition(20.f, 720.f);
+            m_lifeWidget = m_hud.addSprites(heart, sf::Vector2f(40.f, 0.f), 0);
 
-            m_window->draw(bg);
-            m_window->draw(comboText);
+            // WE NEED MORE SUGOI.
+            sf::Sprite sugoi;
+            m_atlas.apply(sugoi, 5);
+            sugoi.setOrigin(sugoi.getGlobalBounds().width / 2, sugoi.getGlobalBounds().height / 2);
+            sugoi.setPosition(m_window->getSize().x / 2, m_window->getSize().y / 2);
+            m_sugoiWidget = m_hud.addSprites(sugoi, sf::Vector2f(0.f, 0.f));
+            m_hud.setVisible(m_sugoiWidget, false);
         }
 
-        // Render the current color affinity.
-        void renderColorAffinity()
+        // Gives the HUD the current score, combo, life and affinity, and renders it again if one changed.
+        void updateHud()
         {
-            sf::Sprite affinity;
-            affinity.setTexture(m_textures.get(3));
+            // The numbers are only formatted when they change.
+            if(m_score != m_hudScore)
+            {
+                m_hudScore = m_score;
+                m_hud.setString(m_scoreWidget, std::string("Score:") + to_string(m_score));
+            }
+
+            if(m_combo != m_hudCombo)
+            {
+                m_hudCombo = m_combo;
+
+                // If good combo, be special.
+                if(m_combo > COMBO_MIN)
+                {
+                    m_hud.setTextStyle(m_comboWidget, 52, sf::Color::Yellow);
+                    m_hud.setString(m_comboWidget, std::string("COMBO: +") + to_string(m_combo));
+                }
+                else
+                {
+                    m_hud.setTextStyle(m_comboWidget, 48, sf::Color::White);
+                    m_hud.setString(m_comboWidget, std::string("Combo: ") + to_string(m_combo));
+                }
+            }
 
             if(m_colorAffinity == sf::Color::Red)
-                affinity.setTextureRect(sf::IntRect(0, 0, 64, 64));
+                m_hud.setTextureRect(m_affinityWidget, m_atlas.map(3, sf::IntRect(0, 0, 64, 64)));
             else if(m_colorAffinity == sf::Color::Blue)
-                affinity.setTextureRect(sf::IntRect(64, 0, 64, 64));
+                m_hud.setTextureRect(m_affinityWidget, m_atlas.map(3, sf::IntRect(64, 0, 64, 64)));
             else if(m_colorAffinity == sf::Color::Green)
-                affinity.setTextureRect(sf::IntRect(64*2, 0, 64, 64));
+                m_hud.setTextureRect(m_affinityWidget, m_atlas.map(3, sf::IntRect(64*2, 0, 64, 64)));
             else if(m_colorAffinity == sf::Color::Yellow)
-                affinity.setTextureRect(sf::IntRect(64*3, 0, 64, 64));
-
-            affinity.setScale(1.5f, 1.5f);
-            affinity.setPosition(m_window->getSize().x - affinity.getGlobalBounds().width - 20.f, 20.f);
-
-            m_window->draw(affinity);
-        }
-
-        // Renders the hearths of the player's life.
-        void renderPlayerLife()
-        {
-            // Prepare the sprite.
-            sf::Sprite heart;
-            heart.setTexture(m_textures.get(4));
+                m_hud.setTextureRect(m_affinityWidget, m_atlas.map(3, sf::IntRect(64*3, 0, 64, 64)));
 
-            // Get the life.
             LifeComponent* life = m_player->getComponent<LifeComponent>("Life");
+            m_hud.setCount(m_lifeWidget, static_cast<unsigned int>(std::max(life->lifepoints, 0)));
 
-            // Draw.
-            for(int i(0) ; i < life->lifepoints ; ++i)
-            {
-                heart.setPosition(20.f + i * 40.f, 720.f);
+            m_hud.setVisible(m_sugoiWidget, m_combo > COMBO_MIN && m_combo % SUGOI_COMBO == 0 && m_lastSugoiDisplay < sf::seconds(1.5f));
 
-                m_window->draw(heart);
-            }
+            m_hud.update();
         }
 
         // Make sure the music is always on !
@@ -1272,23 +2138,12 @@ class World
             }
         }
 
-        // WE NEED MORE SUGOI.
-        void renderSugoi()
-        {
-            sf::Sprite sugoi;
-            sugoi.setTexture(m_textures.get(5));
-            sugoi.setOrigin(sugoi.getGlobalBounds().width / 2, sugoi.getGlobalBounds().height / 2);
-            sugoi.setPosition(m_window->getSize().x / 2, m_window->getSize().y / 2);
-
-            m_window->draw(sugoi);
-        }
-
     protected:
         // Window ptr.
         sf::RenderWindow* m_window;
         bool m_isRunning;
         Difficulty m_difficulty;
-        kantan::TextureHolder m_textures;
+        kantan::TextureAtlas m_atlas;
         kantan::FontHolder m_fonts;
 
         // Music and sound.
@@ -1300,6 +2155,27 @@ class World
         // Event queue.
         std::queue<kantan::Event*> m_eventQueue;
 
+        // Geometry of the walls.
+        kantan::StaticGeometry m_walls;
+
+        // GUI, its widgets, and the values they show.
+        kantan::HudLayer m_hud;
+        std::size_t m_scoreWidget, m_comboWidget, m_affinityWidget, m_lifeWidget, m_sugoiWidget;
+        int m_hudScore, m_hudCombo;
+
+        // Draw commands of the frame, the textures and fonts they use, and what executes them.
+        kantan::RenderResources m_renderResources;
+        kantan::CommandBuffer m_commands;
+        kantan::RenderBackend m_renderBackend;
+
+        // File the next frame is saved to, if any.
+        std::string m_captureFile;
+
+        // Particles of all the explosions, and how many a new one gets.
+        kantan::ParticleEngine m_particles;
+        kantan::ParticleBudget m_particleBudget;
+        sf::Clock m_frameWork;
+
         // Systems.
         LifeSystem m_lifes;
         PhysicSystem m_physics;
@@ -1322,8 +2198,9 @@ class World
         // The last sakura shoot.
         sf::Time m_lastSakuraShoot;
 
-        // The last ball spawn.
+        // The last ball spawn, and the balls found where a new one spawns.
         sf::Time m_lastBallSpawn;
+        std::vector<kantan::Entity*> m_spawnQuery;
 
         // Color affinity.
         sf::Color m_colorAffinity;
@@ -1339,6 +2216,18 @@ class World
 
         // The last time we change affinity.
         sf::Time m_lastAffinityChange;
+
+        // Simulation steps.
+        kantan::FixedTimestep m_timestep;
+
+        // Layers that collide.
+        kantan::CollisionMatrix m_collisionMatrix;
+
+        // Worker threads.
+        kantan::ThreadPool m_threads;
+
+        // Storage order of the entities.
+        kantan::MortonOrder m_mortonOrder;
 };
 
 /**
@@ -1353,9 +2242,15 @@ class MenuWorld
 		MenuWorld(sf::RenderWindow* window)
 		: m_window(window)
 		, m_isRunning(true)
-		, m_spriteRender(window)
-		, m_particleRender(window)
+		, m_commands(&m_renderResources)
+		, m_renderBackend(&m_renderResources)
+		, m_particles(MENU_PARTICLE_CAPACITY)
+		, m_spriteRender(window, &m_commands)
+		, m_particleRender(&m_commands, &m_particles)
+		, m_particleWatcher(&m_particles)
 		{
+			// Explosions that differ from a launch to the next, like in the game.
+			m_particles.setSeed(static_cast<sf::Uint32>(std::rand()));
 		}
 
 		~MenuWorld()
@@ -1372,6 +2267,10 @@ class MenuWorld
 		{
 			// Load assets.
 			m_textures.load(0, "media/textures/smallboxAnimated.png");
+			m_renderResources.addTexture(0, m_textures.get(0));
+
+			m_walls.setTexture(&m_textures.get(0));
+			m_renderResources.addDrawable(0, m_walls);
 
 			// Add boxes for the walls.
 			buildWalls();
@@ -1396,9 +2295,16 @@ class MenuWorld
 
 		void render()
 		{
+			// Walls, in one draw.
+			m_walls.update();
+			m_commands.drawResource(0, WallDrawLayer);
+
 			// Entities.
 			m_particleRender.update(sf::Time::Zero, m_entities, m_eventQueue);
 			m_spriteRender.update(sf::Time::Zero, m_entities, m_eventQueue);
+
+			m_renderBackend.execute(m_commands, *m_window);
+			m_commands.clear();
 		}
 
 		bool isRunning()
@@ -1461,13 +2367,12 @@ class MenuWorld
 			// Create entity & components.
 			kantan::Entity* box = createEntity("Box");
 
-			SpriteComponent* sprite = createComponent<SpriteComponent>();
+			StaticQuadComponent* quad = createComponent<StaticQuadComponent>();
 			AnimationComponent* animation = createComponent<AnimationComponent>();
 
 			// Configure components.
-			sprite->sprite.setTexture(m_textures.get(0));
-			sprite->sprite.setTextureRect(sf::IntRect(0, 0, 64, 64));
-			sprite->sprite.setPosition(position);
+			quad->geometry = &m_walls;
+			quad->quad = m_walls.addQuad(sf::FloatRect(position, sf::Vector2f(64.f, 64.f)), sf::IntRect(0, 0, 64, 64));
 
 			for(unsigned int i(0) ; i < 18 ; ++i)
 				animation->frames.push_back(sf::IntRect(64 * i, 0, 64, 64));
@@ -1476,7 +2381,7 @@ class MenuWorld
 			animation->fps = 24;
 
 			// Add components.
-			box->addComponent(sprite);
+			box->addComponent(quad);
 			box->addComponent(animation);
 		}
 
@@ -1502,18 +2407,19 @@ class MenuWorld
 
 		void createExplosion(sf::Color color, sf::Vector2f position)
 		{
-			// Create entity & components.
-			kantan::Entity* explosion = createEntity("Explosion");
-
-			ParticleComponent* particles = createComponent<ParticleComponent>();
-
-			// Configure components.
-			particles->color = color;
-			particles->center = position;
-			particles->init();
-
-			// Add components.
-			explosion->addComponent(particles);
+			// A burst of 1000 particles in the shared pool, for 2 seconds.
+			kantan::ParticleBurst burst;
+			burst.center = position;
+			burst.color = color;
+			burst.count = 1000;
+			burst.priority = 0;
+			burst.duration = sf::seconds(2.f);
+			burst.minSpeed = 20.f;
+			burst.maxSpeed = 70.f;
+			burst.minLifetime = sf::seconds(1.f);
+			burst.maxLifetime = sf::seconds(3.f);
+
+			m_particles.addBurst(burst);
 		}
 
 	protected:
@@ -1526,6 +2432,17 @@ class MenuWorld
 		// Event queue.
 		std::queue<kantan::Event*> m_eventQueue;
 
+		// Geometry of the walls.
+		kantan::StaticGeometry m_walls;
+
+		// Draw commands of the frame, the textures they use, and what executes them.
+		kantan::RenderResources m_renderResources;
+		kantan::CommandBuffer m_commands;
+		kantan::RenderBackend m_renderBackend;
+
+		// Particles of all the explosions.
+		kantan::ParticleEngine m_particles;
+
 		// Systems.
 		SynchronizeSystem m_synchronize;
 		AnimationSystem m_animations;
@@ -1606,6 +2523,15 @@ class Menu
 	        quitText.setString(L"Quit");
 	        quitText.setPosition(window.getSize().x - 100.f - quitText.getGlobalBounds().width, 250.f + 4.f * 75.f);
 
+	        // Glyphs of every size the texts take, hovered ones included.
+	        kantan::GlyphCache glyphs;
+	        glyphs.addFont("media/fonts/mplus-1m-regular.ttf", font);
+	        glyphs.declare("media/fonts/mplus-1m-regular.ttf", 34, L"Sakura no Hana桜の花");
+	        glyphs.declare("media/fonts/mplus-1m-regular.ttf", editionText.getCharacterSize(), "TOKYO EDITION", false, editionText.getOutlineThickness());
+	        glyphs.declare("media/fonts/mplus-1m-regular.ttf", 30, "EasyNormalHardJapaneseQuit");
+	        glyphs.declare("media/fonts/mplus-1m-regular.ttf", 32, "EasyNormalHardJapaneseQuit");
+	        glyphs.bake();
+
 	        cursorTexture.loadFromFile("media/textures/littlesakura.png");
 	        cursorSprite.setTexture(cursorTexture);
 	        cursorSprite.setOrigin((int)(cursorSprite.getGlobalBounds().width / 2.f), (int)(cursorSprite.getGlobalBounds().height / 2.f));
@@ -1828,6 +2754,9 @@ int main()
                 if (event.type == sf::Event::Closed
                     || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
                     window.close();
+                // [F12] saves the draw commands of the next frame.
+                else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12)
+                    world.captureFrame(CAPTURE_FILE);
             }
 
             // Update the world.